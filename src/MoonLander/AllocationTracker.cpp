@@ -0,0 +1,276 @@
+#include "AllocationTracker.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+
+#include <Corrade/Utility/Assert.h>
+
+#include <box2d/box2d.h>
+
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+#if defined(MOONLANDER_ALLOCATION_TRACKING) && __has_include(<execinfo.h>)
+#include <execinfo.h>
+#include <unistd.h>
+#define MOONLANDER_ALLOCATION_CALLSTACKS
+#endif
+
+#if defined(MOONLANDER_ALLOCATION_TRACKING) && defined(__GLIBC__)
+extern "C" {
+    void *__libc_memalign(std::size_t alignment, std::size_t size);
+    void __libc_free(void *pointer);
+}
+#endif
+
+namespace Magnum::Game {
+    namespace {
+        constexpr std::size_t MaxCallstacks = 64;
+        constexpr std::size_t MaxCallstackDepth = 24;
+
+        struct Callstack {
+            void *frames[MaxCallstackDepth];
+            Int depth;
+            std::size_t size;
+        };
+
+        std::atomic<UnsignedLong> globalAllocations{0};
+        std::atomic<UnsignedLong> globalDeallocations{0};
+        std::atomic<UnsignedLong> globalBytes{0};
+
+        // Box2D's allocator bypasses the hooks below and is counted on its own
+        std::atomic<UnsignedLong> box2DAllocations{0};
+        std::atomic<UnsignedLong> box2DDeallocations{0};
+        std::atomic<UnsignedLong> box2DBytes{0};
+
+        std::atomic<bool> captureCallstacks{false};
+        std::atomic_flag callstackLock = ATOMIC_FLAG_INIT;
+        Callstack callstacks[MaxCallstacks];
+        std::size_t callstackCount = 0;
+
+        // plain data so no allocation or constructor runs on first access
+        thread_local UnsignedLong threadAllocations = 0;
+        thread_local UnsignedLong threadDeallocations = 0;
+        thread_local UnsignedLong threadBytes = 0;
+        thread_local bool insideHook = false;
+
+        [[maybe_unused]] void recordCallstack(const std::size_t size) {
+#ifdef MOONLANDER_ALLOCATION_CALLSTACKS
+            // backtrace() itself may allocate the first time it's called
+            if(!captureCallstacks.load(std::memory_order_relaxed) || insideHook) return;
+            insideHook = true;
+
+            Callstack callstack;
+            callstack.depth = backtrace(callstack.frames, MaxCallstackDepth);
+            callstack.size = size;
+
+            while(callstackLock.test_and_set(std::memory_order_acquire)) {}
+            if(callstackCount < MaxCallstacks) callstacks[callstackCount++] = callstack;
+            callstackLock.clear(std::memory_order_release);
+
+            insideHook = false;
+#else
+            static_cast<void>(size);
+#endif
+        }
+
+        [[maybe_unused]] void recordAllocation(const std::size_t size) {
+            ++threadAllocations;
+            threadBytes += size;
+            globalAllocations.fetch_add(1, std::memory_order_relaxed);
+            globalBytes.fetch_add(size, std::memory_order_relaxed);
+            recordCallstack(size);
+        }
+
+        [[maybe_unused]] void recordDeallocation() {
+            ++threadDeallocations;
+            globalDeallocations.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Box2D asks for at most its B2_ALIGNMENT, 64 covers it and a cache line
+        constexpr std::size_t Box2DAlignment = 64;
+
+        /* Straight to the C runtime and not through the hooked functions, so
+           Box2D's allocations aren't counted twice or mixed into the scope of
+           whichever thread happens to run the solver. */
+        [[maybe_unused]] void *box2DAllocate(const unsigned int size, const int alignment) {
+            CORRADE_INTERNAL_ASSERT(std::size_t(alignment) <= Box2DAlignment);
+            box2DAllocations.fetch_add(1, std::memory_order_relaxed);
+            box2DBytes.fetch_add(size, std::memory_order_relaxed);
+            recordCallstack(size);
+#if defined(MOONLANDER_ALLOCATION_TRACKING) && defined(__GLIBC__)
+            return __libc_memalign(Box2DAlignment, size);
+#elif defined(_MSC_VER)
+            return _aligned_malloc(size, Box2DAlignment);
+#else
+            // aligned_alloc() wants the size to be a multiple of the alignment
+            return std::aligned_alloc(Box2DAlignment, (size + Box2DAlignment - 1)/Box2DAlignment*Box2DAlignment);
+#endif
+        }
+
+        [[maybe_unused]] void box2DFree(void *memory) {
+            if(!memory) return;
+            box2DDeallocations.fetch_add(1, std::memory_order_relaxed);
+#if defined(MOONLANDER_ALLOCATION_TRACKING) && defined(__GLIBC__)
+            __libc_free(memory);
+#elif defined(_MSC_VER)
+            _aligned_free(memory);
+#else
+            std::free(memory);
+#endif
+        }
+    }
+
+    bool AllocationTracker::isEnabled() {
+#ifdef MOONLANDER_ALLOCATION_TRACKING
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    AllocationTracker::Counters AllocationTracker::threadCounters() {
+        return {threadAllocations, threadDeallocations, threadBytes};
+    }
+
+    AllocationTracker::Counters AllocationTracker::globalCounters() {
+        return {
+            globalAllocations.load(std::memory_order_relaxed),
+            globalDeallocations.load(std::memory_order_relaxed),
+            globalBytes.load(std::memory_order_relaxed)
+        };
+    }
+
+    AllocationTracker::Counters AllocationTracker::box2DCounters() {
+        return {
+            box2DAllocations.load(std::memory_order_relaxed),
+            box2DDeallocations.load(std::memory_order_relaxed),
+            box2DBytes.load(std::memory_order_relaxed)
+        };
+    }
+
+    void AllocationTracker::installBox2DAllocator() {
+#ifdef MOONLANDER_ALLOCATION_TRACKING
+        b2SetAllocator(box2DAllocate, box2DFree);
+#endif
+    }
+
+    void AllocationTracker::setCallstackCapture(const bool enabled) {
+#ifdef MOONLANDER_ALLOCATION_CALLSTACKS
+        captureCallstacks.store(enabled, std::memory_order_relaxed);
+#else
+        if(enabled) Warning{} << "[allocations] callstack capture is not available in this build";
+#endif
+    }
+
+    std::size_t AllocationTracker::printCallstacks() {
+#ifdef MOONLANDER_ALLOCATION_CALLSTACKS
+        while(callstackLock.test_and_set(std::memory_order_acquire)) {}
+        const std::size_t count = callstackCount;
+        for(std::size_t i = 0; i != count; ++i) {
+            Error{} << "[allocations] callstack" << i << "of" << count << Debug::nospace << ","
+                << callstacks[i].size << "bytes:";
+            // writes straight to the file descriptor, doesn't allocate
+            backtrace_symbols_fd(callstacks[i].frames, callstacks[i].depth, STDERR_FILENO);
+        }
+        callstackCount = 0;
+        callstackLock.clear(std::memory_order_release);
+        return count;
+#else
+        return 0;
+#endif
+    }
+}
+
+#ifdef MOONLANDER_ALLOCATION_TRACKING
+#if defined(__GLIBC__)
+/*
+ * glibc supports replacing the malloc family in the executable. Forwarding
+ * to the __libc_* entry points counts operator new as well as Corrade's
+ * malloc-based growable array allocator.
+ */
+extern "C" {
+    void *__libc_malloc(std::size_t size);
+    void *__libc_calloc(std::size_t count, std::size_t size);
+    void *__libc_realloc(void *pointer, std::size_t size);
+
+    void *malloc(const std::size_t size) {
+        Magnum::Game::recordAllocation(size);
+        return __libc_malloc(size);
+    }
+
+    void *calloc(const std::size_t count, const std::size_t size) {
+        Magnum::Game::recordAllocation(count*size);
+        return __libc_calloc(count, size);
+    }
+
+    void *realloc(void *pointer, const std::size_t size) {
+        // a move to a new block, so freeing the old one counts as well
+        if(size) Magnum::Game::recordAllocation(size);
+        if(pointer) Magnum::Game::recordDeallocation();
+        return __libc_realloc(pointer, size);
+    }
+
+    void *memalign(const std::size_t alignment, const std::size_t size) {
+        Magnum::Game::recordAllocation(size);
+        return __libc_memalign(alignment, size);
+    }
+
+    void *aligned_alloc(const std::size_t alignment, const std::size_t size) {
+        Magnum::Game::recordAllocation(size);
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void **pointer, const std::size_t alignment, const std::size_t size) {
+        Magnum::Game::recordAllocation(size);
+        *pointer = __libc_memalign(alignment, size);
+        return *pointer ? 0 : ENOMEM;
+    }
+
+    void free(void *pointer) {
+        if(pointer) Magnum::Game::recordDeallocation();
+        __libc_free(pointer);
+    }
+}
+#else
+/* Elsewhere only C++ allocations are seen */
+void *operator new(const std::size_t size) {
+    Magnum::Game::recordAllocation(size);
+    if(void *pointer = std::malloc(size ? size : 1)) return pointer;
+    throw std::bad_alloc{};
+}
+
+void *operator new[](const std::size_t size) {
+    return ::operator new(size);
+}
+
+void *operator new(const std::size_t size, const std::nothrow_t &) noexcept {
+    Magnum::Game::recordAllocation(size);
+    return std::malloc(size ? size : 1);
+}
+
+void *operator new[](const std::size_t size, const std::nothrow_t &) noexcept {
+    return ::operator new(size, std::nothrow);
+}
+
+void operator delete(void *pointer) noexcept {
+    if(pointer) Magnum::Game::recordDeallocation();
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+    ::operator delete(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+    ::operator delete(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept {
+    ::operator delete(pointer);
+}
+#endif
+#endif
@@ -0,0 +1,187 @@
+#ifndef MAGNUM_MOONLANDER_ALLOCATIONTRACKER_H
+#define MAGNUM_MOONLANDER_ALLOCATIONTRACKER_H
+
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Utility/Debug.h>
+
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Functions.h>
+
+namespace Magnum::Game {
+    /**
+     * Opt-in heap allocation tracker. When built with
+     * MOONLANDER_ALLOCATION_TRACKING, AllocationTracker.cpp hooks the global
+     * allocation functions (malloc & co. on glibc, so growable arrays
+     * are seen as well, operator new elsewhere) and Box2D's allocator and
+     * counts every allocation. Box2D allocates on the solver's threads, so
+     * its allocations are kept apart from the others in counters of their
+     * own. Otherwise all counters stay at zero.
+     *
+     * Instances collect per-frame statistics for named scopes, see Scope,
+     * and for Box2D.
+     */
+    class AllocationTracker {
+    public:
+        struct Counters {
+            UnsignedLong allocations;
+            UnsignedLong deallocations;
+            UnsignedLong bytes;
+        };
+
+        /// Whether the allocation hooks are compiled in
+        static bool isEnabled();
+
+        /// Allocations done by the calling thread
+        static Counters threadCounters();
+
+        /// Allocations done by all threads
+        static Counters globalCounters();
+
+        /// Allocations done by Box2D on all threads, not part of the other counters
+        static Counters box2DCounters();
+
+        /// Route Box2D allocations through the tracked allocator, call before creating a world
+        static void installBox2DAllocator();
+
+        /**
+         * Start or stop recording callstacks of allocations. A bounded
+         * number of callstacks is kept until printCallstacks().
+         */
+        static void setCallstackCapture(bool enabled);
+
+        /// Print recorded callstacks to standard error and discard them, returns their count
+        static std::size_t printCallstacks();
+
+        enum class Threads: UnsignedByte {
+            /// Only the thread that created the scope
+            Calling,
+            /**
+             * Every thread, for work fanned out to a WorkerPool. Anything
+             * other threads allocate meanwhile is counted as well, so
+             * don't let such scopes overlap.
+             */
+            All
+        };
+
+        /**
+         * Counts allocations done during its lifetime into a scope of an
+         * AllocationTracker, by default only those of the current thread.
+         */
+        class Scope {
+        public:
+            Scope(AllocationTracker &tracker, const UnsignedInt id, const Threads threads = Threads::Calling):
+                _tracker(tracker), _id(id), _threads(threads), _start(counters()) {}
+
+            ~Scope() {
+                const Counters end = counters();
+                ScopeStatistics &scope = _tracker._scopes[_id];
+                scope.frameAllocations += end.allocations - _start.allocations;
+                scope.frameBytes += end.bytes - _start.bytes;
+            }
+
+            Scope(const Scope &) = delete;
+            Scope &operator=(const Scope &) = delete;
+
+        private:
+            Counters counters() const {
+                return _threads == Threads::All ? globalCounters() : threadCounters();
+            }
+
+            AllocationTracker &_tracker;
+            UnsignedInt _id;
+            Threads _threads;
+            Counters _start;
+        };
+
+        /// Registers a named scope, do this at startup since it allocates
+        UnsignedInt addScope(const char *name) {
+            Containers::arrayAppend(_scopes, ScopeStatistics{name});
+            return UnsignedInt(_scopes.size() - 1);
+        }
+
+        [[nodiscard]] UnsignedLong frameCount() const {
+            return _frames;
+        }
+
+        /// Allocations counted by all scopes in the current frame so far
+        [[nodiscard]] UnsignedLong frameAllocations() const {
+            UnsignedLong allocations = 0;
+            for(const ScopeStatistics &scope: _scopes) allocations += scope.frameAllocations;
+            return allocations;
+        }
+
+        /// Box2D allocations in the current frame so far
+        [[nodiscard]] UnsignedLong frameBox2DAllocations() const {
+            return box2DCounters().allocations - _box2DStart.allocations;
+        }
+
+        /// Fold the current frame into the totals and start a new one
+        void endFrame() {
+            const Counters box2D = box2DCounters();
+            _box2D.frameAllocations = box2D.allocations - _box2DStart.allocations;
+            _box2D.frameBytes = box2D.bytes - _box2DStart.bytes;
+            _box2DStart = box2D;
+            _box2D.fold();
+
+            for(ScopeStatistics &scope: _scopes) scope.fold();
+
+            ++_frames;
+        }
+
+        void print() const {
+            if(!isEnabled()) {
+                Debug{} << "[allocations] tracking not compiled in (MOONLANDER_ALLOCATION_TRACKING)";
+                return;
+            }
+
+            Debug{} << "[allocations] over" << _frames << "frames:";
+            for(const ScopeStatistics &scope: _scopes) scope.print();
+            _box2D.print();
+
+            const Counters global = globalCounters();
+            Debug{} << "    process allocations:" << global.allocations
+                << "deallocations:" << global.deallocations << "bytes:" << global.bytes;
+            const Counters box2D = box2DCounters();
+            Debug{} << "    Box2D allocations:" << box2D.allocations
+                << "deallocations:" << box2D.deallocations << "bytes:" << box2D.bytes;
+        }
+
+    private:
+        struct ScopeStatistics {
+            const char *name;
+            UnsignedLong frameAllocations;
+            UnsignedLong frameBytes;
+            UnsignedLong allocations;
+            UnsignedLong bytes;
+            UnsignedLong framesWithAllocations;
+            UnsignedLong maxFrameAllocations;
+            UnsignedLong maxFrameBytes;
+
+            void fold() {
+                if(frameAllocations) ++framesWithAllocations;
+                maxFrameAllocations = Math::max(maxFrameAllocations, frameAllocations);
+                maxFrameBytes = Math::max(maxFrameBytes, frameBytes);
+                allocations += frameAllocations;
+                bytes += frameBytes;
+                frameAllocations = 0;
+                frameBytes = 0;
+            }
+
+            void print() const {
+                Debug{} << "   " << name << "allocations:" << allocations
+                    << "bytes:" << bytes
+                    << "frames with allocations:" << framesWithAllocations
+                    << "max per frame:" << maxFrameAllocations
+                    << Debug::nospace << "/" << Debug::nospace << maxFrameBytes << "bytes";
+            }
+        };
+
+        Containers::Array<ScopeStatistics> _scopes;
+        // Box2D allocations are counted across threads and folded like a scope
+        ScopeStatistics _box2D{"Box2D, all threads"};
+        Counters _box2DStart = box2DCounters();
+        UnsignedLong _frames = 0;
+    };
+}
+
+#endif //MAGNUM_MOONLANDER_ALLOCATIONTRACKER_H
@@ -0,0 +1,135 @@
+#ifndef MAGNUM_MOONLANDER_ANIMATIONSYSTEM_H
+#define MAGNUM_MOONLANDER_ANIMATIONSYSTEM_H
+
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Utility/Assert.h>
+#include <Magnum/Math/Functions.h>
+
+namespace Magnum::Game {
+    /**
+     * Owns every looping frame animation and advances all of them in one
+     * pass from the game's fixed tick. State is kept in flat arrays and the
+     * current frame of each track is written into a contiguous frame index
+     * array, which sprites read from directly (see Sprite::setFrameSource()).
+     *
+     * Capacity is fixed at construction so references returned from
+     * frameIndex() stay valid for the lifetime of the system.
+     */
+    class AnimationSystem {
+    private:
+        std::size_t _count = 0;
+
+        Containers::Array<Float> _time;
+        Containers::Array<Float> _duration;
+        Containers::Array<Float> _framesPerSecond;
+        Containers::Array<Float> _rate;
+        // rate if playing, zero if paused, so advance() doesn't branch
+        Containers::Array<Float> _speed;
+        Containers::Array<bool> _playing;
+        Containers::Array<Int> _lastFrame;
+        Containers::Array<Int> _frameIndices;
+
+    public:
+        explicit AnimationSystem(const std::size_t capacity):
+            _time{ValueInit, capacity},
+            _duration{ValueInit, capacity},
+            _framesPerSecond{ValueInit, capacity},
+            _rate{ValueInit, capacity},
+            _speed{ValueInit, capacity},
+            _playing{ValueInit, capacity},
+            _lastFrame{ValueInit, capacity},
+            _frameIndices{ValueInit, capacity} {}
+
+        /**
+         * Registers a new looping track, paused at its first frame.
+         * @return Track id used by the other functions
+         */
+        UnsignedInt add(const Int frameCount, const Float frameDelay) {
+            CORRADE_ASSERT(_count < _frameIndices.size(),
+                "AnimationSystem::add(): capacity of" << _frameIndices.size() << "tracks reached", 0);
+            CORRADE_ASSERT(frameCount > 0 && frameDelay > 0.0f,
+                "AnimationSystem::add(): invalid frame count" << frameCount << "or delay" << frameDelay, 0);
+
+            const std::size_t id = _count++;
+            _time[id] = 0.0f;
+            _duration[id] = Float(frameCount)*frameDelay;
+            _framesPerSecond[id] = 1.0f/frameDelay;
+            _rate[id] = 1.0f;
+            _speed[id] = 0.0f;
+            _playing[id] = false;
+            _lastFrame[id] = frameCount - 1;
+            _frameIndices[id] = 0;
+
+            return UnsignedInt(id);
+        }
+
+        void play(const UnsignedInt id) {
+            _playing[id] = true;
+            _speed[id] = _rate[id];
+        }
+
+        void pause(const UnsignedInt id) {
+            _playing[id] = false;
+            _speed[id] = 0.0f;
+        }
+
+        [[nodiscard]] bool isPlaying(const UnsignedInt id) const {
+            return _playing[id];
+        }
+
+        /// Jump to @p time seconds into the track, wrapped to its duration
+        void seek(const UnsignedInt id, const Float time) {
+            _time[id] = wrap(time, _duration[id]);
+            _frameIndices[id] = frameAt(id);
+        }
+
+        /// Playback rate multiplier, negative values play backwards
+        void setRate(const UnsignedInt id, const Float rate) {
+            _rate[id] = rate;
+            if(_playing[id]) _speed[id] = rate;
+        }
+
+        [[nodiscard]] Float rate(const UnsignedInt id) const {
+            return _rate[id];
+        }
+
+        [[nodiscard]] const Int& frameIndex(const UnsignedInt id) const {
+            return _frameIndices[id];
+        }
+
+        [[nodiscard]] Containers::ArrayView<const Int> frameIndices() const {
+            return _frameIndices.prefix(_count);
+        }
+
+        [[nodiscard]] std::size_t count() const {
+            return _count;
+        }
+
+        [[nodiscard]] std::size_t capacity() const {
+            return _frameIndices.size();
+        }
+
+        /// Advance all tracks, returns how many of them switched to another frame
+        std::size_t advance(const Float dt) {
+            std::size_t changed = 0;
+            for(std::size_t i = 0; i != _count; ++i) {
+                _time[i] = wrap(_time[i] + dt*_speed[i], _duration[i]);
+                const Int frame = frameAt(i);
+                changed += frame != _frameIndices[i];
+                _frameIndices[i] = frame;
+            }
+            return changed;
+        }
+
+    private:
+        static Float wrap(const Float time, const Float duration) {
+            return time - duration*Math::floor(time/duration);
+        }
+
+        [[nodiscard]] Int frameAt(const std::size_t id) const {
+            return Math::min(Int(_time[id]*_framesPerSecond[id]), _lastFrame[id]);
+        }
+    };
+}
+
+#endif //MAGNUM_MOONLANDER_ANIMATIONSYSTEM_H
@@ -0,0 +1,46 @@
+#ifndef MAGNUM_MOONLANDER_ASSETID_H
+#define MAGNUM_MOONLANDER_ASSETID_H
+
+#include <cstddef>
+
+#include <Magnum/Magnum.h>
+
+namespace Magnum::Game {
+    /// FNV-1a hash of a resource filename, usable in constant expressions
+    constexpr UnsignedInt assetId(const char *filename) {
+        UnsignedInt hash = 2166136261u;
+        for(; *filename; ++filename) {
+            hash = (hash ^ UnsignedByte(*filename))*16777619u;
+        }
+        return hash;
+    }
+
+    /**
+     * A file in the compiled-in resources together with its ID. The ones
+     * for res/resources.conf are generated into the Assets namespace, so
+     * a typo in a name is a compile error instead of an empty texture.
+     */
+    struct AssetName {
+        constexpr explicit AssetName(const char *filename): filename{filename}, id{assetId(filename)} {}
+
+        const char *filename;
+        UnsignedInt id;
+    };
+
+    template<std::size_t size> constexpr bool hasDistinctIds(const AssetName(&names)[size]) {
+        for(std::size_t i = 0; i != size; ++i) {
+            for(std::size_t j = i + 1; j != size; ++j) {
+                if(names[i].id == names[j].id) return false;
+            }
+        }
+        return true;
+    }
+}
+
+// Assets::<name> and Assets::All, generated from res/resources.conf by CMake
+#include <asset_names.h>
+
+static_assert(Magnum::Game::hasDistinctIds(Magnum::Game::Assets::All),
+              "asset ID collision, rename one of the files in res/resources.conf");
+
+#endif //MAGNUM_MOONLANDER_ASSETID_H
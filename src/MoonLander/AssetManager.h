@@ -5,23 +5,156 @@
 
 #include <Corrade/Utility/Resource.h>
 #include <Corrade/PluginManager/Manager.h>
+#include <Corrade/Containers/GrowableArray.h>
 #include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/Pointer.h>
+#include <Corrade/Utility/Assert.h>
+#include <Corrade/Utility/DebugStl.h>
 
 #include <Magnum/GL/Texture.h>
 #include <Magnum/GL/TextureFormat.h>
+#include <Magnum/Math/Functions.h>
 
 #include <Magnum/Trade/ImageData.h>
 #include <Magnum/Trade/AbstractImporter.h>
 
 #include <Magnum/ImageView.h>
 
+#include "AssetId.h"
+
 namespace Magnum::Game {
+    /**
+     * Generational index into the AssetManager texture table. Resolve it
+     * once with addTexture() or find(), lookups are then an array index
+     * and a generation compare. A handle whose texture was removed is
+     * stale, which asserts in debug builds.
+     */
+    struct TextureHandle {
+        UnsignedShort index = 0xffff;
+        UnsignedShort generation = 0;
+
+        [[nodiscard]] constexpr bool isNull() const {
+            return index == 0xffff;
+        }
+    };
+
+    /**
+     * Textures loaded from the compiled-in resources, with their video
+     * memory accounted for. Above the budget the least recently used
+     * textures are evicted and loaded again by the next getTexture().
+     * Textures something keeps a reference to, like a Sprite, have to be
+     * pinned so they're never evicted under it.
+     */
     class AssetManager {
     private:
+        struct Entry {
+            // points to an AssetName literal
+            const char *filename;
+            UnsignedInt id;
+            GL::Texture2D texture{NoCreate};
+            std::size_t bytes = 0;
+            // mip levels in the file, all of them are uploaded
+            Int levels = 1;
+            // value of the use clock at the last getTexture()
+            UnsignedLong lastUse = 0;
+            UnsignedInt pins = 0;
+            bool resident = false;
+        };
+
+        // entries are heap-allocated, texture references stay valid as the table grows
+        struct Slot {
+            Containers::Pointer<Entry> entry;
+            UnsignedShort generation = 0;
+        };
+
         PluginManager::Manager<Trade::AbstractImporter> _manager;
         Containers::Pointer<Trade::AbstractImporter> _importer;
-        std::unordered_map<std::string, GL::Texture2D> _assets;
+        Containers::Array<Slot> _slots;
+        Containers::Array<UnsignedShort> _freeSlots;
+        // asset ID to slot, only used when resolving handles
+        std::unordered_map<UnsignedInt, UnsignedShort> _ids;
         Utility::Resource _resource;
+
+        // zero is unlimited
+        std::size_t _budget = 0;
+        std::size_t _residentBytes = 0;
+        std::size_t _peakBytes = 0;
+        UnsignedLong _useClock = 0;
+        UnsignedLong _evictionCount = 0;
+        UnsignedLong _reloadCount = 0;
+
+        // the only check on the lookup path, release builds trust the handle
+        void checkHandle(const TextureHandle handle) const {
+#ifndef NDEBUG
+            if(!isValid(handle)) {
+                Fatal{} << "AssetManager: stale texture handle" << handle.index << handle.generation;
+            }
+#else
+            static_cast<void>(handle);
+#endif
+        }
+
+        Entry &entry(const TextureHandle handle) {
+            checkHandle(handle);
+            return *_slots[handle.index].entry;
+        }
+
+        const Entry &entry(const TextureHandle handle) const {
+            checkHandle(handle);
+            return *_slots[handle.index].entry;
+        }
+
+        void upload(Entry &entry) {
+            Optional<Trade::ImageData2D> image = loadImage(entry.filename);
+            entry.levels = Int(_importer->image2DLevelCount(0));
+
+            GL::Texture2D texture;
+            texture.setWrapping(GL::SamplerWrapping::ClampToEdge)
+                    .setMagnificationFilter(GL::SamplerFilter::Linear)
+                    .setMinificationFilter(GL::SamplerFilter::Linear,
+                                           entry.levels > 1 ? GL::SamplerMipmap::Linear : GL::SamplerMipmap::Base)
+                    .setStorage(entry.levels, GL::textureFormat(image->format()), image->size())
+                    .setSubImage(0, {}, *image)
+                    .setMagnificationFilter(SamplerFilter::Nearest);
+
+            // format x dimensions of every level the file has
+            entry.bytes = std::size_t(image->size().product())*image->pixelSize();
+            for(Int level = 1; level != entry.levels; ++level) {
+                Optional<Trade::ImageData2D> mip = _importer->image2D(0, UnsignedInt(level));
+                CORRADE_INTERNAL_ASSERT(mip);
+                texture.setSubImage(level, {}, *mip);
+                entry.bytes += std::size_t(mip->size().product())*mip->pixelSize();
+            }
+
+            entry.texture = std::move(texture);
+            entry.resident = true;
+            _residentBytes += entry.bytes;
+            _peakBytes = Math::max(_peakBytes, _residentBytes);
+        }
+
+        void evict(Entry &entry) {
+            entry.texture = GL::Texture2D{NoCreate};
+            entry.resident = false;
+            _residentBytes -= entry.bytes;
+            ++_evictionCount;
+        }
+
+        /// Evict least recently used unpinned textures until under budget, except @p keep
+        void enforceBudget(const Entry *keep = nullptr) {
+            while(_budget && _residentBytes > _budget) {
+                Entry *oldest = nullptr;
+                for(Slot &slot: _slots) {
+                    Entry *entry = slot.entry.get();
+                    if(!entry || !entry->resident || entry->pins || entry == keep) continue;
+                    if(!oldest || entry->lastUse < oldest->lastUse) oldest = entry;
+                }
+
+                // everything left is in use, the budget is too small for this scene
+                if(!oldest) return;
+                evict(*oldest);
+            }
+        }
+
     public:
         AssetManager(): _resource{"sprites"} {
             /* Load image importer plugin */
@@ -31,23 +164,153 @@ namespace Magnum::Game {
             if(!_importer) std::exit(1);
         };
 
-        void addTexture(const std::string& key, const std::string& filename) {
-            Optional<Trade::ImageData2D> image = loadImage(filename);
-            const Vector2i imageSize = image->size();
+        /// Load @p name, or return the handle of the already loaded texture
+        TextureHandle addTexture(const AssetName &name) {
+            if(const TextureHandle existing = find(name.id); !existing.isNull()) {
+                return existing;
+            }
 
-            GL::Texture2D texture;
-            texture.setWrapping(GL::SamplerWrapping::ClampToEdge)
-                    .setMagnificationFilter(GL::SamplerFilter::Linear)
-                    .setMinificationFilter(GL::SamplerFilter::Linear)
-                    .setStorage(1, GL::textureFormat(image->format()), imageSize)
-                    .setSubImage(0, {}, *image)
-                    .setMagnificationFilter(SamplerFilter::Nearest);
+            UnsignedShort index;
+            if(!_freeSlots.isEmpty()) {
+                index = _freeSlots[_freeSlots.size() - 1];
+                Containers::arrayRemoveSuffix(_freeSlots);
+            } else {
+                index = UnsignedShort(_slots.size());
+                Containers::arrayAppend(_slots, Slot{});
+            }
+
+            Slot &slot = _slots[index];
+            slot.entry = Containers::pointer<Entry>();
+            slot.entry->filename = name.filename;
+            slot.entry->id = name.id;
+            slot.entry->lastUse = ++_useClock;
+            _ids.emplace(name.id, index);
+
+            upload(*slot.entry);
+            enforceBudget(slot.entry.get());
+            return {index, slot.generation};
+        }
+
+        /**
+         * Unload the texture, every handle to it becomes stale. A pinned
+         * texture is still referenced, by a Sprite for example, and can't
+         * be removed until it's unpinned.
+         */
+        void removeTexture(const TextureHandle handle) {
+            Entry &removed = entry(handle);
+            CORRADE_ASSERT(!removed.pins,
+                "AssetManager::removeTexture():" << removed.filename << "is pinned" << removed.pins << "times", );
+            if(removed.resident) {
+                _residentBytes -= removed.bytes;
+            }
+            _ids.erase(removed.id);
+
+            Slot &slot = _slots[handle.index];
+            slot.entry = nullptr;
+            ++slot.generation;
+            Containers::arrayAppend(_freeSlots, handle.index);
+        }
+
+        /// Handle of a loaded texture, a null handle if it wasn't added
+        [[nodiscard]] TextureHandle find(const UnsignedInt id) const {
+            const auto found = _ids.find(id);
+            if(found == _ids.end()) return {};
+            return {found->second, _slots[found->second].generation};
+        }
+
+        [[nodiscard]] TextureHandle find(const AssetName &name) const {
+            return find(name.id);
+        }
+
+        /// Whether @p handle refers to a texture that wasn't removed since
+        [[nodiscard]] bool isValid(const TextureHandle handle) const {
+            return handle.index < _slots.size() && _slots[handle.index].generation == handle.generation
+                && _slots[handle.index].entry;
+        }
+
+        /**
+         * Texture for @p handle, loaded again if it was evicted. Not on a
+         * per-frame path, so unlike other lookups an unknown or stale
+         * handle is fatal in release builds too.
+         */
+        GL::Texture2D &getTexture(const TextureHandle handle) {
+            if(!isValid(handle)) {
+                Fatal{} << "AssetManager::getTexture(): unknown texture handle" << handle.index << handle.generation;
+            }
+
+            Entry &found = entry(handle);
+            found.lastUse = ++_useClock;
+            if(!found.resident) {
+                upload(found);
+                ++_reloadCount;
+                enforceBudget(&found);
+            }
+
+            return found.texture;
+        }
+
+        /// Keep the texture resident no matter the budget, calls nest
+        void pin(const TextureHandle handle) {
+            ++entry(handle).pins;
+        }
+
+        void unpin(const TextureHandle handle) {
+            if(Entry &found = entry(handle); found.pins) {
+                --found.pins;
+                enforceBudget();
+            }
+        }
+
+        /// Video memory budget in bytes, zero is unlimited
+        void setBudget(const std::size_t bytes) {
+            _budget = bytes;
+            enforceBudget();
+        }
+
+        [[nodiscard]] std::size_t getBudget() const {
+            return _budget;
+        }
+
+        /// Video memory taken by textures currently loaded
+        [[nodiscard]] std::size_t getResidentBytes() const {
+            return _residentBytes;
+        }
+
+        [[nodiscard]] std::size_t getPeakBytes() const {
+            return _peakBytes;
+        }
+
+        /// Size of the texture when loaded
+        [[nodiscard]] std::size_t getTextureBytes(const TextureHandle handle) const {
+            return entry(handle).bytes;
+        }
+
+        [[nodiscard]] bool isResident(const TextureHandle handle) const {
+            return entry(handle).resident;
+        }
+
+        [[nodiscard]] std::size_t getTextureCount() const {
+            return _ids.size();
+        }
+
+        [[nodiscard]] UnsignedLong getEvictionCount() const {
+            return _evictionCount;
+        }
 
-            _assets.try_emplace(key, std::move(texture));
+        [[nodiscard]] UnsignedLong getReloadCount() const {
+            return _reloadCount;
         }
 
-        GL::Texture2D* getTexture(const std::string& key) {
-            return &_assets[key];
+        void print() const {
+            Debug{} << "[assets]" << _ids.size() << "textures," << _residentBytes << "bytes resident, peak"
+                << _peakBytes << Debug::nospace << ", budget" << _budget << Debug::nospace << ","
+                << _evictionCount << "evictions," << _reloadCount << "reloads";
+            for(const Slot &slot: _slots) {
+                if(!slot.entry) continue;
+                const Entry &entry = *slot.entry;
+                Debug{} << "  " << entry.filename << entry.bytes << "bytes"
+                    << (entry.resident ? "resident" : "evicted") << (entry.pins ? "pinned" : "");
+            }
         }
 
         Optional<Trade::ImageData2D> loadImage(const std::string& filename) {
@@ -0,0 +1,107 @@
+#ifndef MAGNUM_MOONLANDER_BACKGROUNDLAYER_H
+#define MAGNUM_MOONLANDER_BACKGROUNDLAYER_H
+
+#include <Magnum/GL/AbstractFramebuffer.h>
+#include <Magnum/GL/Framebuffer.h>
+#include <Magnum/GL/Mesh.h>
+#include <Magnum/GL/Texture.h>
+#include <Magnum/GL/TextureFormat.h>
+#include <Magnum/Math/Color.h>
+#include <Magnum/Math/Matrix3.h>
+#include <Magnum/MeshTools/Compile.h>
+#include <Magnum/Primitives/Square.h>
+#include <Magnum/SceneGraph/Camera.h>
+#include <Magnum/Trade/MeshData.h>
+
+#include "ShaderCache.h"
+#include "Trace.h"
+
+namespace Magnum::Game {
+    /**
+     * Render-to-texture cache of the static part of the level. The static
+     * geometry is drawn into a texture only when the camera moves or the
+     * level reports a change, every other frame just composites the
+     * texture with one fullscreen quad.
+     */
+    class BackgroundLayer {
+    public:
+        explicit BackgroundLayer(ShaderCache &shaders, const Vector2i &size):
+            _shader(shaders.flat(FlatShader::Flag::Textured|FlatShader::Flag::TextureTransformation)),
+            _quad(MeshTools::compile(Primitives::squareSolid(Primitives::SquareFlag::TextureCoordinates)))
+        {
+            setSize(size);
+        }
+
+        void setSize(const Vector2i &size) {
+            _texture = GL::Texture2D{};
+            _texture.setWrapping(GL::SamplerWrapping::ClampToEdge)
+                .setMagnificationFilter(GL::SamplerFilter::Nearest)
+                .setMinificationFilter(GL::SamplerFilter::Nearest)
+                .setStorage(1, GL::TextureFormat::RGBA8, size);
+
+            _framebuffer = GL::Framebuffer{{{}, size}};
+            _framebuffer.attachTexture(GL::Framebuffer::ColorAttachment{0}, _texture, 0);
+            _valid = false;
+        }
+
+        void invalidate() {
+            _valid = false;
+        }
+
+        /// Re-renders the layer count since construction
+        [[nodiscard]] UnsignedLong getRenderCount() const {
+            return _renderCount;
+        }
+
+        /**
+         * Re-render the layer if the camera or @p revision changed since the
+         * last time, then bind @p target again.
+         * @param camera Camera the layer is seen through
+         * @param revision Changes whenever the static geometry does
+         * @param drawStatic Draws the static geometry
+         * @param target Framebuffer the frame is drawn into
+         * @return Whether the layer was re-rendered
+         */
+        template<class DrawStatic> bool update(SceneGraph::Camera2D &camera, const UnsignedLong revision,
+                                               DrawStatic &&drawStatic, GL::AbstractFramebuffer &target) {
+            const Matrix3 cameraMatrix = camera.projectionMatrix()*camera.cameraMatrix();
+            if(_valid && revision == _revision && cameraMatrix == _cameraMatrix) return false;
+
+            Trace::Scope traceScope{"BackgroundLayer::render"};
+
+            // premultiplied, transparent where there's no static geometry
+            _framebuffer.clearColor(0, Color4{0.0f})
+                .bind();
+            drawStatic(camera);
+            target.bind();
+
+            _cameraMatrix = cameraMatrix;
+            _revision = revision;
+            _valid = true;
+            ++_renderCount;
+            return true;
+        }
+
+        void draw() {
+            // the quad spans -1 to 1, exactly the clip space
+            _shader.setTransformationProjectionMatrix(Matrix3{})
+                .setTextureMatrix(Matrix3{})
+                .setColor(Color4{1.0f})
+                .bindTexture(_texture)
+                .draw(_quad);
+        }
+
+    private:
+        FlatShader &_shader;
+        GL::Mesh _quad;
+        GL::Texture2D _texture{NoCreate};
+        GL::Framebuffer _framebuffer{NoCreate};
+
+        Matrix3 _cameraMatrix;
+        UnsignedLong _revision = 0;
+        bool _valid = false;
+        UnsignedLong _renderCount = 0;
+    };
+}
+
+#endif //MAGNUM_MOONLANDER_BACKGROUNDLAYER_H
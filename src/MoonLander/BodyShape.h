@@ -0,0 +1,216 @@
+#ifndef MAGNUM_MOONLANDER_BODYSHAPE_H
+#define MAGNUM_MOONLANDER_BODYSHAPE_H
+
+#include <cstring>
+
+#include <Corrade/Containers/ArrayView.h>
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Utility/Debug.h>
+
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Vector2.h>
+
+#include <box2d/box2d.h>
+
+namespace Magnum::Game {
+    /**
+     * Collision shape of a body, in body-local coordinates. The same
+     * description creates the Box2D shape and the matching outline for the
+     * mesh, and identifies the mesh in MeshCache.
+     */
+    struct BodyShape {
+        enum class Type: UnsignedByte {
+            Box,
+            RoundedBox,
+            Polygon,
+            Circle
+        };
+
+        static constexpr UnsignedInt MaxPoints = B2_MAX_POLYGON_VERTICES;
+
+        Type type = Type::Box;
+        UnsignedInt pointCount = 0;
+        /// Box and rounded box half size, the corner radius comes on top
+        Vector2 halfSize;
+        /// Circle radius, corner radius of rounded boxes and polygons
+        Float radius = 0.0f;
+        /// Polygon points, counterclockwise
+        Vector2 points[MaxPoints]{};
+
+        static BodyShape box(const Vector2 &halfSize) {
+            BodyShape shape;
+            shape.type = Type::Box;
+            shape.halfSize = halfSize;
+            return shape;
+        }
+
+        static BodyShape roundedBox(const Vector2 &halfSize, const Float radius) {
+            BodyShape shape;
+            shape.type = Type::RoundedBox;
+            shape.halfSize = halfSize;
+            shape.radius = radius;
+            return shape;
+        }
+
+        static BodyShape circle(const Float radius) {
+            BodyShape shape;
+            shape.type = Type::Circle;
+            shape.radius = radius;
+            return shape;
+        }
+
+        /**
+         * Convex hull of @p points, at most MaxPoints of them. Falls back to
+         * a unit box if they don't span an area.
+         */
+        static BodyShape polygon(const Containers::ArrayView<const Vector2> points, const Float radius = 0.0f) {
+            b2Vec2 input[MaxPoints];
+            const UnsignedInt count = UnsignedInt(Math::min(points.size(), std::size_t(MaxPoints)));
+            for(UnsignedInt i = 0; i != count; ++i) {
+                input[i] = {points[i].x(), points[i].y()};
+            }
+
+            const b2Hull hull = b2ComputeHull(input, Int(count));
+            if(hull.count < 3) {
+                Error{} << "BodyShape::polygon(): degenerate hull of" << points.size() << "points, using a box";
+                return box(Vector2{0.5f});
+            }
+
+            BodyShape shape;
+            shape.type = Type::Polygon;
+            shape.radius = radius;
+            shape.pointCount = UnsignedInt(hull.count);
+            for(UnsignedInt i = 0; i != shape.pointCount; ++i) {
+                shape.points[i] = {hull.points[i].x, hull.points[i].y};
+            }
+            return shape;
+        }
+
+        /// Regular polygon with @p sides corners on a circle of @p radius
+        static BodyShape regularPolygon(const UnsignedInt sides, const Float radius, const Float cornerRadius = 0.0f) {
+            Vector2 points[MaxPoints];
+            const UnsignedInt count = Math::clamp(sides, 3u, MaxPoints);
+            for(UnsignedInt i = 0; i != count; ++i) {
+                const Rad angle{Constants::tau()*Float(i)/Float(count)};
+                points[i] = {radius*Math::cos(angle), radius*Math::sin(angle)};
+            }
+            return polygon({points, count}, cornerRadius);
+        }
+
+        /// Add the shape to @p bodyId
+        b2ShapeId create(const b2BodyId bodyId, const b2ShapeDef &shapeDefinition) const {
+            switch(type) {
+                case Type::Circle: {
+                    const b2Circle circle{{0.0f, 0.0f}, radius};
+                    return b2CreateCircleShape(bodyId, &shapeDefinition, &circle);
+                }
+                case Type::RoundedBox: {
+                    const b2Polygon polygon = b2MakeRoundedBox(halfSize.x(), halfSize.y(), radius);
+                    return b2CreatePolygonShape(bodyId, &shapeDefinition, &polygon);
+                }
+                case Type::Polygon: {
+                    b2Vec2 hullPoints[MaxPoints];
+                    for(UnsignedInt i = 0; i != pointCount; ++i) {
+                        hullPoints[i] = {points[i].x(), points[i].y()};
+                    }
+                    const b2Hull hull = b2ComputeHull(hullPoints, Int(pointCount));
+                    const b2Polygon polygon = b2MakePolygon(&hull, radius);
+                    return b2CreatePolygonShape(bodyId, &shapeDefinition, &polygon);
+                }
+                case Type::Box:
+                    break;
+            }
+
+            const b2Polygon polygon = b2MakeBox(halfSize.x(), halfSize.y());
+            return b2CreatePolygonShape(bodyId, &shapeDefinition, &polygon);
+        }
+
+        /**
+         * Append the outline, counterclockwise and convex, so it can be
+         * drawn as a triangle fan. Rounded corners get @p cornerSegments
+         * segments, circles about one segment per 0.1 units of
+         * circumference.
+         */
+        void outline(Containers::Array<Vector2> &out, const UnsignedInt cornerSegments = 4) const {
+            if(type == Type::Circle) {
+                const UnsignedInt segments = Math::clamp(UnsignedInt(Constants::tau()*radius*10.0f), 12u, 64u);
+                for(UnsignedInt i = 0; i != segments; ++i) {
+                    const Rad angle{Constants::tau()*Float(i)/Float(segments)};
+                    Containers::arrayAppend(out, Vector2{Math::cos(angle), Math::sin(angle)}*radius);
+                }
+                return;
+            }
+
+            Vector2 corners[MaxPoints];
+            UnsignedInt count = pointCount;
+            if(type == Type::Polygon) {
+                std::memcpy(corners, points, sizeof(Vector2)*count);
+            } else {
+                count = 4;
+                corners[0] = {-halfSize.x(), -halfSize.y()};
+                corners[1] = { halfSize.x(), -halfSize.y()};
+                corners[2] = { halfSize.x(),  halfSize.y()};
+                corners[3] = {-halfSize.x(),  halfSize.y()};
+            }
+
+            if(radius <= 0.0f) {
+                Containers::arrayAppend(out, Containers::arrayView(corners, count));
+                return;
+            }
+
+            // sweep an arc around every corner, from the previous edge's normal to the next one's
+            for(UnsignedInt i = 0; i != count; ++i) {
+                const Vector2 &previous = corners[(i + count - 1) % count];
+                const Vector2 &corner = corners[i];
+                const Vector2 &next = corners[(i + 1) % count];
+                const Vector2 normalIn = -(corner - previous).perpendicular().normalized();
+                const Vector2 normalOut = -(next - corner).perpendicular().normalized();
+
+                const Float from = Float(Math::atan2(normalIn.y(), normalIn.x()));
+                Float to = Float(Math::atan2(normalOut.y(), normalOut.x()));
+                if(to < from) to += Constants::tau();
+
+                for(UnsignedInt segment = 0; segment <= cornerSegments; ++segment) {
+                    const Rad angle{Math::lerp(from, to, Float(segment)/Float(cornerSegments))};
+                    Containers::arrayAppend(out, corner + Vector2{Math::cos(angle), Math::sin(angle)}*radius);
+                }
+            }
+        }
+
+        /// Hash of all parameters, equal shapes hash equal
+        [[nodiscard]] std::size_t hash() const {
+            // FNV-1a over the bytes that are in use
+            UnsignedLong value = 14695981039346656037ull;
+            const auto add = [&value](const void *data, const std::size_t size) {
+                const auto *bytes = static_cast<const UnsignedByte*>(data);
+                for(std::size_t i = 0; i != size; ++i) {
+                    value = (value ^ bytes[i])*1099511628211ull;
+                }
+            };
+
+            add(&type, sizeof(type));
+            add(&pointCount, sizeof(pointCount));
+            add(&halfSize, sizeof(halfSize));
+            add(&radius, sizeof(radius));
+            add(points, sizeof(Vector2)*pointCount);
+            return std::size_t(value);
+        }
+
+        /// Exact comparison, Magnum's vector comparison is fuzzy and wouldn't agree with hash()
+        bool operator==(const BodyShape &other) const {
+            return type == other.type && pointCount == other.pointCount &&
+                std::memcmp(&halfSize, &other.halfSize, sizeof(halfSize)) == 0 &&
+                std::memcmp(&radius, &other.radius, sizeof(radius)) == 0 &&
+                std::memcmp(points, other.points, sizeof(Vector2)*pointCount) == 0;
+        }
+
+        struct Hash {
+            std::size_t operator()(const BodyShape &shape) const {
+                return shape.hash();
+            }
+        };
+    };
+}
+
+#endif //MAGNUM_MOONLANDER_BODYSHAPE_H
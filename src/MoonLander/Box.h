@@ -13,6 +13,14 @@ namespace Magnum::Game {
             Box(Object2D &object, const b2BodyId bodyId, DrawableMesh &drawable) :
             _object(object), _bodyId(bodyId), _drawable(drawable) {}
 
+            [[nodiscard]] Object2D &getObject() const {
+                return _object;
+            }
+
+            [[nodiscard]] b2BodyId getBodyId() const {
+                return _bodyId;
+            }
+
             void update(const Float dt) {
                 const auto userData = b2Body_GetUserData(_bodyId);
                 const auto [x, y] = b2Body_GetPosition(_bodyId);
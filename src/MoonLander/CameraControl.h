@@ -1,6 +1,7 @@
 #ifndef MAGNUM_MOONLANDER_CAMERACONTROL_H
 #define MAGNUM_MOONLANDER_CAMERACONTROL_H
 
+#include <Magnum/Math/Range.h>
 #include <Magnum/SceneGraph/Camera.h>
 
 #include "Game.h"
@@ -22,6 +23,7 @@ namespace Magnum::Game {
         };
 
         [[nodiscard]] Vector2 getContainerTranslation() const;
+        [[nodiscard]] Range2D viewRectangle() const;
         [[nodiscard]] Vector2 projectedPosition(Vector2 screenPosition, Vector2 screenSize) const;
 
         void move(Vector2 displacement) const;
@@ -281,6 +283,11 @@ namespace Magnum::Game {
         return _cameraObject->translation();
     }
 
+    /// World-space rectangle visible through the camera
+    inline Range2D CameraControl::viewRectangle() const {
+        return Range2D::fromCenter(_cameraObject->translation(), _camera->projectionSize()*0.5f);
+    }
+
     inline void CameraControl::OnScrollEvent(Sdl2Application::ScrollEvent& event)
     {
         if(_disableInput) {
@@ -0,0 +1,109 @@
+#ifndef MAGNUM_MOONLANDER_COLLISION_H
+#define MAGNUM_MOONLANDER_COLLISION_H
+
+#include <limits>
+
+#include <Magnum/Magnum.h>
+
+#include <box2d/box2d.h>
+
+namespace Magnum::Game {
+    /// Collision category bits, one per kind of shape
+    namespace CollisionCategory {
+        constexpr UnsignedLong Terrain = 1 << 0;
+        constexpr UnsignedLong Static = 1 << 1;
+        constexpr UnsignedLong Lander = 1 << 2;
+        constexpr UnsignedLong Box = 1 << 3;
+        constexpr UnsignedLong Debris = 1 << 4;
+        constexpr UnsignedLong Sensor = 1 << 5;
+        constexpr UnsignedLong Rope = 1 << 6;
+
+        /// Every category above
+        constexpr UnsignedLong Used = Terrain|Static|Lander|Box|Debris|Sensor|Rope;
+
+        constexpr UnsignedLong All = ~UnsignedLong{};
+    }
+
+    // Box2D 3.0 has 32-bit filter bits, 3.1 made them 64-bit
+    static_assert(CollisionCategory::Used <= std::numeric_limits<decltype(b2Filter::categoryBits)>::max() &&
+                  CollisionCategory::Used <= std::numeric_limits<decltype(b2QueryFilter::categoryBits)>::max(),
+                  "collision categories don't fit Box2D's filter bits");
+
+    /**
+     * What a shape is and what it collides with. Box2D only creates a
+     * broadphase pair if each shape's category is in the other's mask, so
+     * narrow masks keep the pair count down in dense scenes.
+     */
+    struct CollisionFilter {
+        UnsignedLong category;
+        UnsignedLong mask;
+        bool isSensor = false;
+
+        /// Terrain and baked static geometry only touch things that move
+        static constexpr CollisionFilter terrain() {
+            return {CollisionCategory::Terrain,
+                    CollisionCategory::Lander|CollisionCategory::Box|CollisionCategory::Debris|CollisionCategory::Rope};
+        }
+
+        static constexpr CollisionFilter staticGeometry() {
+            return {CollisionCategory::Static,
+                    CollisionCategory::Lander|CollisionCategory::Box|CollisionCategory::Debris|CollisionCategory::Rope};
+        }
+
+        static constexpr CollisionFilter lander() {
+            return {CollisionCategory::Lander, CollisionCategory::All};
+        }
+
+        static constexpr CollisionFilter box() {
+            return {CollisionCategory::Box, CollisionCategory::All & ~CollisionCategory::Sensor};
+        }
+
+        /**
+         * Small pieces that rest on the world and get pushed by the lander,
+         * but pass through each other, boxes and ropes. There are
+         * thousands of them and pairs with all the boxes would cost more
+         * than they add.
+         */
+        static constexpr CollisionFilter debris() {
+            return {CollisionCategory::Debris, CollisionCategory::Terrain|CollisionCategory::Static|CollisionCategory::Lander};
+        }
+
+        /// Rope segments drape over the ground but pass through everything that moves, each other included
+        static constexpr CollisionFilter rope() {
+            return {CollisionCategory::Rope, CollisionCategory::Terrain|CollisionCategory::Static};
+        }
+
+        /// Reports overlaps with the lander, doesn't push anything
+        static constexpr CollisionFilter sensor() {
+            return {CollisionCategory::Sensor, CollisionCategory::Lander, true};
+        }
+
+        [[nodiscard]] b2Filter toBox2D() const {
+            b2Filter filter = b2DefaultFilter();
+            // All is cut to the width of Box2D's bits on purpose, the categories are checked to fit above
+            filter.categoryBits = decltype(filter.categoryBits)(category);
+            filter.maskBits = decltype(filter.maskBits)(mask);
+            return filter;
+        }
+
+        void apply(b2ShapeDef &shapeDefinition) const {
+            shapeDefinition.filter = toBox2D();
+            shapeDefinition.isSensor = isSensor;
+            if(isSensor) shapeDefinition.enableSensorEvents = true;
+        }
+
+        /**
+         * Ray and overlap query hitting shapes of the @p mask categories.
+         * Box2D also checks the shape's mask against the query category, so
+         * the query claims every category to not get filtered out by that.
+         */
+        [[nodiscard]] static b2QueryFilter query(const UnsignedLong mask) {
+            b2QueryFilter filter = b2DefaultQueryFilter();
+            filter.categoryBits = decltype(filter.categoryBits)(CollisionCategory::All);
+            filter.maskBits = decltype(filter.maskBits)(mask);
+            return filter;
+        }
+    };
+}
+
+#endif //MAGNUM_MOONLANDER_COLLISION_H
@@ -0,0 +1,331 @@
+#ifndef MAGNUM_MOONLANDER_DEBRISPOOL_H
+#define MAGNUM_MOONLANDER_DEBRISPOOL_H
+
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Utility/Debug.h>
+
+#include <Magnum/GL/Buffer.h>
+#include <Magnum/GL/Mesh.h>
+#include <Magnum/GL/Texture.h>
+#include <Magnum/Math/Color.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Matrix3.h>
+
+#include <box2d/box2d.h>
+
+#include "Collision.h"
+#include "FloatingOrigin.h"
+#include "FractureTemplates.h"
+#include "Level.h"
+#include "ShaderCache.h"
+#include "Trace.h"
+
+namespace Magnum::Game {
+    /**
+     * Bounded pool of debris bodies for things breaking apart. All bodies
+     * are created up front, disabled, so they cost nothing in the solver or
+     * the broadphase; a spawn only reshapes, places and enables as many as
+     * the fracture template has pieces. The oldest pieces are reclaimed
+     * after their lifetime, or early once the pool runs out.
+     *
+     * Pieces are drawn textured with a cut of their sprite, streamed into
+     * one mesh per template and drawn with one call each.
+     */
+    class DebrisPool {
+    public:
+        static constexpr ShaderCache::Flags ShaderFlags =
+            FlatShader::Flag::Textured|FlatShader::Flag::VertexColor;
+
+        struct Configuration {
+            /// Pieces alive at once
+            UnsignedInt capacity = 256;
+            /// Seconds until a piece is reclaimed
+            Float lifetime = 8.0f;
+            /// Seconds of fading out before that
+            Float fadeTime = 1.5f;
+            /// Speed away from the parent's center, on top of the inherited velocity
+            Float burstSpeed = 1.5f;
+            CollisionFilter filter = CollisionFilter::debris();
+        };
+
+        DebrisPool(ShaderCache &shaders, const b2WorldId worldId): DebrisPool{shaders, worldId, Configuration{}} {}
+
+        explicit DebrisPool(ShaderCache &shaders, const b2WorldId worldId, const Configuration &configuration):
+            _shader(shaders.flat(ShaderFlags)), _worldId(worldId), _configuration(configuration)
+        {
+            Trace::Scope traceScope{"DebrisPool::DebrisPool"};
+
+            b2BodyDef bodyDefinition = b2DefaultBodyDef();
+            bodyDefinition.type = b2_dynamicBody;
+            bodyDefinition.isEnabled = false;
+
+            b2ShapeDef shapeDefinition = b2DefaultShapeDef();
+            configuration.filter.apply(shapeDefinition);
+            // debris doesn't carve craters, a crash would rebuild half the terrain
+            shapeDefinition.enableHitEvents = false;
+            shapeDefinition.enableContactEvents = false;
+            const b2Polygon placeholder = b2MakeBox(0.1f, 0.1f);
+
+            const UnsignedInt capacity = Math::max(configuration.capacity, 1u);
+            Containers::arrayReserve(_slots, capacity);
+            Containers::arrayReserve(_free, capacity);
+            _active = Containers::Array<UnsignedInt>{NoInit, capacity};
+            for(UnsignedInt i = 0; i != capacity; ++i) {
+                const b2BodyId bodyId = b2CreateBody(worldId, &bodyDefinition);
+                const b2ShapeId shapeId = b2CreatePolygonShape(bodyId, &shapeDefinition, &placeholder);
+                b2Shape_SetFriction(shapeId, BodyDefault::friction);
+                Containers::arrayAppend(_slots, Slot{bodyId, shapeId});
+                Containers::arrayAppend(_free, capacity - i - 1);
+            }
+        }
+
+        DebrisPool(const DebrisPool &) = delete;
+        DebrisPool &operator=(const DebrisPool &) = delete;
+
+        ~DebrisPool() {
+            // the world may be gone already, taking the bodies with it
+            if(!b2World_IsValid(_worldId)) return;
+            for(const Slot &slot: _slots) b2DestroyBody(slot.bodyId);
+        }
+
+        /**
+         * Make pieces of @p fracture for a sprite of @p halfSize world
+         * units and @p mass, drawn with @p texture. The polygons are
+         * prepared here so spawn() doesn't compute any hulls. The texture
+         * has to stay resident.
+         */
+        UnsignedInt addTemplate(const FractureTemplate &fracture, const Vector2 &halfSize, const Float mass,
+                                GL::Texture2D &texture) {
+            Containers::arrayAppend(_templates, InPlaceInit);
+            Template &t = _templates[_templates.size() - 1];
+            t.texture = &texture;
+            t.mesh.setPrimitive(GL::MeshPrimitive::Triangles)
+                .addVertexBuffer(t.buffer, 0, FlatShader::Position{},
+                                 FlatShader::TextureCoordinates{}, colorAttribute());
+
+            for(UnsignedInt i = 0; i != fracture.pieceCount; ++i) {
+                const FracturePiece &piece = fracture.pieces[i];
+                Piece prepared;
+                prepared.offset = piece.centroid*halfSize;
+                prepared.pointCount = piece.pointCount;
+
+                b2Vec2 points[FracturePiece::MaxPoints];
+                for(UnsignedInt j = 0; j != piece.pointCount; ++j) {
+                    const Vector2 local = piece.points[j]*halfSize - prepared.offset;
+                    points[j] = {local.x(), local.y()};
+                    prepared.points[j] = local;
+                    prepared.textureCoordinates[j] = (piece.points[j] + Vector2{1.0f})*0.5f;
+                }
+                const b2Hull hull = b2ComputeHull(points, Int(piece.pointCount));
+                prepared.polygon = b2MakePolygon(&hull, 0.0f);
+                const Float area = piece.massFraction*4.0f*halfSize.product();
+                prepared.density = mass*piece.massFraction/area;
+                Containers::arrayAppend(t.pieces, prepared);
+            }
+
+            return UnsignedInt(_templates.size() - 1);
+        }
+
+        /**
+         * Break the body @p parentId into the pieces of template
+         * @p templateId. Pieces start where the parent's sprite had them,
+         * moving with the parent's velocity at their position. The parent
+         * is left as it is.
+         * @return Pieces spawned
+         */
+        UnsignedInt spawn(const UnsignedInt templateId, const b2BodyId parentId) {
+            return spawn(templateId, b2Body_GetTransform(parentId), b2Body_GetLinearVelocity(parentId),
+                         b2Body_GetAngularVelocity(parentId));
+        }
+
+        UnsignedInt spawn(const UnsignedInt templateId, const b2Transform &transform, const b2Vec2 linearVelocity,
+                          const Float angularVelocity) {
+            Trace::Scope traceScope{"DebrisPool::spawn"};
+
+            const Template &t = _templates[templateId];
+            for(UnsignedInt i = 0; i != t.pieces.size(); ++i) {
+                const Piece &piece = t.pieces[i];
+                const UnsignedInt slotId = acquire();
+                Slot &slot = _slots[slotId];
+                slot.templateId = templateId;
+                slot.piece = i;
+                slot.spawnTime = _time;
+
+                const b2Vec2 offset = b2RotateVector(transform.q, {piece.offset.x(), piece.offset.y()});
+                b2Shape_SetPolygon(slot.shapeId, &piece.polygon);
+                b2Body_SetTransform(slot.bodyId, b2Add(transform.p, offset), transform.q);
+                b2Body_Enable(slot.bodyId);
+                b2Shape_SetDensity(slot.shapeId, piece.density, true);
+
+                // velocity of the parent at the piece, plus a push outwards
+                const b2Vec2 spin = b2CrossSV(angularVelocity, offset);
+                const b2Vec2 burst = b2MulSV(_configuration.burstSpeed, b2Normalize(offset));
+                b2Body_SetLinearVelocity(slot.bodyId, b2Add(b2Add(linearVelocity, spin), burst));
+                b2Body_SetAngularVelocity(slot.bodyId, angularVelocity);
+            }
+
+            ++_spawnCount;
+            return UnsignedInt(t.pieces.size());
+        }
+
+        /// Age the pieces and reclaim the expired ones, the oldest are always first
+        void update(const Float dt) {
+            _time += dt;
+            while(_activeCount && _time - _slots[_active[_activeBegin]].spawnTime >= _configuration.lifetime) {
+                release();
+            }
+        }
+
+        void draw(const Matrix3 &transformationProjectionMatrix) {
+            if(!_activeCount) return;
+
+            Trace::Scope traceScope{"DebrisPool::draw"};
+
+            for(Template &t: _templates) Containers::arrayClear(t.vertices);
+
+            for(UnsignedInt i = 0; i != _activeCount; ++i) {
+                const Slot &slot = _slots[_active[(_activeBegin + i) % _active.size()]];
+                Template &t = _templates[slot.templateId];
+                const Piece &piece = t.pieces[slot.piece];
+
+                const Float age = _time - slot.spawnTime;
+                const Float fade = Math::clamp((_configuration.lifetime - age)/_configuration.fadeTime, 0.0f, 1.0f);
+                // premultiplied, the blend function is One, OneMinusSourceAlpha
+                const UnsignedByte alpha = UnsignedByte(fade*255.0f);
+                const Color4ub color{alpha, alpha, alpha, alpha};
+
+                const b2Transform transform = b2Body_GetTransform(slot.bodyId);
+                const auto vertex = [&](const UnsignedInt j) {
+                    const b2Vec2 p = b2TransformPoint(transform, {piece.points[j].x(), piece.points[j].y()});
+                    return Vertex{{p.x, p.y}, piece.textureCoordinates[j], color};
+                };
+                for(UnsignedInt j = 2; j < piece.pointCount; ++j) {
+                    Containers::arrayAppend(t.vertices, vertex(0));
+                    Containers::arrayAppend(t.vertices, vertex(j - 1));
+                    Containers::arrayAppend(t.vertices, vertex(j));
+                }
+            }
+
+            _shader.setTransformationProjectionMatrix(transformationProjectionMatrix)
+                .setColor(Color4{1.0f});
+            for(Template &t: _templates) {
+                if(t.vertices.isEmpty()) continue;
+
+                // orphan and refill, the driver doesn't have to wait for the previous frame
+                t.buffer.setData(t.vertices, GL::BufferUsage::StreamDraw);
+                t.mesh.setCount(Int(t.vertices.size()));
+                _shader.bindTexture(*t.texture).draw(t.mesh);
+            }
+        }
+
+        /// Move the active pieces by -@p shift, returns how many there are
+        UnsignedInt shiftOrigin(const Vector2 &shift) {
+            for(UnsignedInt i = 0; i != _activeCount; ++i) {
+                shiftBody(_slots[_active[(_activeBegin + i) % _active.size()]].bodyId, shift);
+            }
+            return _activeCount;
+        }
+
+        [[nodiscard]] UnsignedInt getCapacity() const {
+            return UnsignedInt(_slots.size());
+        }
+
+        [[nodiscard]] UnsignedInt getActiveCount() const {
+            return _activeCount;
+        }
+
+        [[nodiscard]] UnsignedLong getSpawnCount() const {
+            return _spawnCount;
+        }
+
+        /// Pieces reclaimed before their lifetime to make room
+        [[nodiscard]] UnsignedLong getRecycledCount() const {
+            return _recycledCount;
+        }
+
+        void print() const {
+            Debug{} << "[debris]" << _activeCount << "of" << _slots.size() << "pieces active," << _spawnCount
+                << "spawns," << _recycledCount << "pieces recycled early";
+        }
+
+    private:
+        struct Vertex {
+            Vector2 position;
+            Vector2 textureCoordinates;
+            Color4ub color;
+        };
+
+        struct Piece {
+            // body origin relative to the parent's
+            Vector2 offset;
+            b2Polygon polygon;
+            Float density;
+            UnsignedInt pointCount;
+            // outline relative to the body origin
+            Vector2 points[FracturePiece::MaxPoints];
+            Vector2 textureCoordinates[FracturePiece::MaxPoints];
+        };
+
+        struct Template {
+            GL::Texture2D *texture = nullptr;
+            Containers::Array<Piece> pieces;
+            Containers::Array<Vertex> vertices;
+            GL::Buffer buffer;
+            GL::Mesh mesh;
+        };
+
+        struct Slot {
+            b2BodyId bodyId;
+            b2ShapeId shapeId;
+            UnsignedInt templateId = 0;
+            UnsignedInt piece = 0;
+            Float spawnTime = 0.0f;
+        };
+
+        static FlatShader::Color4 colorAttribute() {
+            using Color = FlatShader::Color4;
+            return Color{Color::DataType::UnsignedByte, Color::DataOption::Normalized};
+        }
+
+        // a free slot, or the oldest active one if there's none
+        UnsignedInt acquire() {
+            if(_free.isEmpty()) {
+                release();
+                ++_recycledCount;
+            }
+
+            const UnsignedInt slotId = _free[_free.size() - 1];
+            Containers::arrayRemoveSuffix(_free);
+            _active[(_activeBegin + _activeCount) % _active.size()] = slotId;
+            ++_activeCount;
+            return slotId;
+        }
+
+        void release() {
+            const UnsignedInt slotId = _active[_activeBegin];
+            _activeBegin = (_activeBegin + 1) % UnsignedInt(_active.size());
+            --_activeCount;
+
+            b2Body_Disable(_slots[slotId].bodyId);
+            Containers::arrayAppend(_free, slotId);
+        }
+
+        FlatShader &_shader;
+        b2WorldId _worldId;
+        Configuration _configuration;
+
+        Containers::Array<Template> _templates;
+        Containers::Array<Slot> _slots;
+        Containers::Array<UnsignedInt> _free;
+        // ring of active slots in spawn order, so the oldest is at _activeBegin
+        Containers::Array<UnsignedInt> _active;
+        UnsignedInt _activeBegin = 0;
+        UnsignedInt _activeCount = 0;
+
+        Float _time = 0.0f;
+        UnsignedLong _spawnCount = 0;
+        UnsignedLong _recycledCount = 0;
+    };
+}
+
+#endif //MAGNUM_MOONLANDER_DEBRISPOOL_H
@@ -0,0 +1,341 @@
+#ifndef MAGNUM_MOONLANDER_DEBUGDRAW_H
+#define MAGNUM_MOONLANDER_DEBUGDRAW_H
+
+#include <Corrade/Containers/EnumSet.h>
+#include <Corrade/Containers/GrowableArray.h>
+
+#include <Magnum/GL/Buffer.h>
+#include <Magnum/GL/Mesh.h>
+#include <Magnum/Math/Color.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Matrix3.h>
+#include <Magnum/Math/Range.h>
+
+#include <box2d/box2d.h>
+
+#include "ShaderCache.h"
+#include "Trace.h"
+
+namespace Magnum::Game {
+    /**
+     * Box2D debug draw backend. The b2DebugDraw callbacks only append
+     * vertices to two CPU arrays, one with line segments and one with
+     * triangles; both are streamed to the GPU once per frame and drawn
+     * with one vertex-colored draw call each. Box2D culls against the
+     * view rectangle, so only bodies on screen cost anything.
+     */
+    class DebugDraw {
+    public:
+        enum class Category: UnsignedByte {
+            /// Shape outlines and fills
+            Shapes = 1 << 0,
+            Joints = 1 << 1,
+            /// Fat AABBs of the broadphase
+            Bounds = 1 << 2,
+            /// Centers of mass and body transforms
+            Mass = 1 << 3,
+            /// Contact points and normals
+            Contacts = 1 << 4,
+            /// Normal and friction impulses of contacts
+            Impulses = 1 << 5,
+            /// Shapes colored by constraint graph color
+            GraphColors = 1 << 6
+        };
+
+        using Categories = Containers::EnumSet<Category>;
+        CORRADE_ENUMSET_FRIEND_OPERATORS(Categories)
+
+        static constexpr ShaderCache::Flags ShaderFlags = FlatShader::Flag::VertexColor;
+
+        explicit DebugDraw(ShaderCache &shaders, const Categories categories = Category::Shapes|Category::Joints):
+            _shader(shaders.flat(ShaderFlags)), _categories(categories)
+        {
+            for(std::size_t i = 0; i != CircleSegments; ++i) {
+                const Rad angle{Float(i)*Constants::tau()/Float(CircleSegments)};
+                _unitCircle[i] = {Math::cos(angle), Math::sin(angle)};
+            }
+
+            _lineMesh.setPrimitive(GL::MeshPrimitive::Lines)
+                .addVertexBuffer(_lineBuffer, 0, FlatShader::Position{}, colorAttribute());
+            _triangleMesh.setPrimitive(GL::MeshPrimitive::Triangles)
+                .addVertexBuffer(_triangleBuffer, 0, FlatShader::Position{}, colorAttribute());
+        }
+
+        [[nodiscard]] Categories getCategories() const {
+            return _categories;
+        }
+
+        void setCategories(const Categories categories) {
+            _categories = categories;
+        }
+
+        void toggle(const Category category) {
+            _categories ^= category;
+        }
+
+        /// Line vertices submitted by the last draw()
+        [[nodiscard]] std::size_t getLineVertexCount() const {
+            return _lines.size();
+        }
+
+        /// Triangle vertices submitted by the last draw()
+        [[nodiscard]] std::size_t getTriangleVertexCount() const {
+            return _triangles.size();
+        }
+
+        /**
+         * Collect and draw the world as seen through the view.
+         * @param worldId World to draw
+         * @param view Visible rectangle in world units, used for culling
+         * @param transformationProjectionMatrix Camera projection times camera matrix
+         * @param pixelSize World units per framebuffer pixel, for point sizes
+         */
+        void draw(const b2WorldId worldId, const Range2D &view, const Matrix3 &transformationProjectionMatrix,
+                  const Float pixelSize) {
+            Trace::Scope traceScope{"DebugDraw::draw"};
+
+            // keeps the capacity, after the first frames nothing allocates
+            Containers::arrayClear(_lines);
+            Containers::arrayClear(_triangles);
+            _pixelSize = pixelSize;
+
+            {
+                Trace::Scope collectScope{"b2World_Draw"};
+                b2DebugDraw debugDraw{};
+                setup(debugDraw, view);
+                b2World_Draw(worldId, &debugDraw);
+            }
+
+            // orphan and refill, the driver doesn't have to wait for the previous frame
+            _shader.setTransformationProjectionMatrix(transformationProjectionMatrix)
+                .setColor(Color4{1.0f});
+            if(!_triangles.isEmpty()) {
+                _triangleBuffer.setData(_triangles, GL::BufferUsage::StreamDraw);
+                _triangleMesh.setCount(Int(_triangles.size()));
+                _shader.draw(_triangleMesh);
+            }
+            if(!_lines.isEmpty()) {
+                _lineBuffer.setData(_lines, GL::BufferUsage::StreamDraw);
+                _lineMesh.setCount(Int(_lines.size()));
+                _shader.draw(_lineMesh);
+            }
+        }
+
+    private:
+        // packed to 12 bytes, tens of thousands of shapes stream every frame
+        struct Vertex {
+            Vector2 position;
+            Color4ub color;
+        };
+
+        static FlatShader::Color4 colorAttribute() {
+            using Color = FlatShader::Color4;
+            return Color{Color::DataType::UnsignedByte, Color::DataOption::Normalized};
+        }
+
+        static constexpr std::size_t CircleSegments = 16;
+        // premultiplied alpha of shape fills
+        static constexpr UnsignedInt FillAlpha = 96;
+        static constexpr Float AxisLength = 0.4f;
+
+        static DebugDraw &self(void *context) {
+            return *static_cast<DebugDraw*>(context);
+        }
+
+        static Color4ub color(const b2HexColor color, const UnsignedInt alpha = 255) {
+            const auto hex = UnsignedInt(color);
+            return {UnsignedByte(((hex >> 16) & 0xff)*alpha/255),
+                    UnsignedByte(((hex >> 8) & 0xff)*alpha/255),
+                    UnsignedByte((hex & 0xff)*alpha/255),
+                    UnsignedByte(alpha)};
+        }
+
+        static Vector2 transformPoint(const b2Transform &transform, const b2Vec2 &point) {
+            const b2Vec2 p = b2TransformPoint(transform, point);
+            return {p.x, p.y};
+        }
+
+        void line(const Vector2 &a, const Vector2 &b, const Color4ub &color) {
+            Containers::arrayAppend(_lines, {Vertex{a, color}, Vertex{b, color}});
+        }
+
+        void triangle(const Vector2 &a, const Vector2 &b, const Vector2 &c, const Color4ub &color) {
+            Containers::arrayAppend(_triangles, {Vertex{a, color}, Vertex{b, color}, Vertex{c, color}});
+        }
+
+        void circle(const Vector2 &center, const Float radius, const Color4ub &outline) {
+            for(std::size_t i = 0; i != CircleSegments; ++i) {
+                line(center + _unitCircle[i]*radius, center + _unitCircle[(i + 1) % CircleSegments]*radius, outline);
+            }
+        }
+
+        void disc(const Vector2 &center, const Float radius, const Color4ub &fill) {
+            for(std::size_t i = 0; i != CircleSegments; ++i) {
+                triangle(center, center + _unitCircle[i]*radius, center + _unitCircle[(i + 1) % CircleSegments]*radius, fill);
+            }
+        }
+
+        static void drawPolygon(const b2Vec2 *vertices, const int vertexCount, const b2HexColor hexColor, void *context) {
+            DebugDraw &d = self(context);
+            const Color4ub outline = color(hexColor);
+            for(int i = 0, j = vertexCount - 1; i < vertexCount; j = i++) {
+                d.line({vertices[j].x, vertices[j].y}, {vertices[i].x, vertices[i].y}, outline);
+            }
+        }
+
+        // the rounding radius isn't shown, the core polygon is close enough for debugging
+        static void drawSolidPolygon(const b2Transform transform, const b2Vec2 *vertices, const int vertexCount,
+                                     float, const b2HexColor hexColor, void *context) {
+            DebugDraw &d = self(context);
+            const Color4ub outline = color(hexColor);
+            const Color4ub fill = color(hexColor, FillAlpha);
+
+            const Vector2 first = transformPoint(transform, vertices[0]);
+            Vector2 previous = transformPoint(transform, vertices[vertexCount - 1]);
+            for(int i = 0; i < vertexCount; ++i) {
+                const Vector2 current = i ? transformPoint(transform, vertices[i]) : first;
+                d.line(previous, current, outline);
+                if(i >= 2) d.triangle(first, previous, current, fill);
+                previous = current;
+            }
+        }
+
+        static void drawCircle(const b2Vec2 center, const float radius, const b2HexColor hexColor, void *context) {
+            self(context).circle({center.x, center.y}, radius, color(hexColor));
+        }
+
+        static void drawSolidCircle(const b2Transform transform, const float radius, const b2HexColor hexColor,
+                                    void *context) {
+            DebugDraw &d = self(context);
+            const Vector2 center{transform.p.x, transform.p.y};
+            const Color4ub outline = color(hexColor);
+            d.disc(center, radius, color(hexColor, FillAlpha));
+            d.circle(center, radius, outline);
+            // a radius line shows the rotation
+            d.line(center, center + Vector2{transform.q.c, transform.q.s}*radius, outline);
+        }
+
+        static void drawSolidCapsule(const b2Vec2 p1, const b2Vec2 p2, const float radius, const b2HexColor hexColor,
+                                     void *context) {
+            DebugDraw &d = self(context);
+            const Vector2 a{p1.x, p1.y};
+            const Vector2 b{p2.x, p2.y};
+            const Vector2 side = (b - a).isZero() ? Vector2::xAxis(radius) : (b - a).normalized().perpendicular()*radius;
+            const Color4ub outline = color(hexColor);
+            const Color4ub fill = color(hexColor, FillAlpha);
+
+            d.triangle(a + side, a - side, b - side, fill);
+            d.triangle(a + side, b - side, b + side, fill);
+            d.disc(a, radius, fill);
+            d.disc(b, radius, fill);
+            d.line(a + side, b + side, outline);
+            d.line(a - side, b - side, outline);
+            d.circle(a, radius, outline);
+            d.circle(b, radius, outline);
+        }
+
+        static void drawSegment(const b2Vec2 p1, const b2Vec2 p2, const b2HexColor hexColor, void *context) {
+            self(context).line({p1.x, p1.y}, {p2.x, p2.y}, color(hexColor));
+        }
+
+        static void drawTransform(const b2Transform transform, void *context) {
+            DebugDraw &d = self(context);
+            const Vector2 origin{transform.p.x, transform.p.y};
+            const Vector2 x{transform.q.c, transform.q.s};
+            d.line(origin, origin + x*AxisLength, color(b2_colorRed));
+            d.line(origin, origin + x.perpendicular()*AxisLength, color(b2_colorGreen));
+        }
+
+        static void drawPoint(const b2Vec2 p, const float size, const b2HexColor hexColor, void *context) {
+            DebugDraw &d = self(context);
+            // size is in pixels, keep it constant when zooming
+            const Vector2 half{size*0.5f*d._pixelSize};
+            const Vector2 center{p.x, p.y};
+            const Color4ub c = color(hexColor);
+            d.triangle(center - half, center + Vector2{half.x(), -half.y()}, center + half, c);
+            d.triangle(center - half, center + half, center + Vector2{-half.x(), half.y()}, c);
+        }
+
+        /*
+         * Fills the callback struct, on every draw since the categories and
+         * the view change. A template so members that differ between Box2D
+         * versions can be set only if present: 3.1 renamed the callbacks to
+         * *Fcn, dropped DrawCapsule and renamed drawAABBs, later versions
+         * rename or drop some of the contact flags.
+         */
+        template<class T> void setup(T &debugDraw, const Range2D &view) {
+            // there's no text rendering here
+            if constexpr(requires { debugDraw.DrawPolygonFcn; }) {
+                debugDraw.DrawPolygonFcn = drawPolygon;
+                debugDraw.DrawSolidPolygonFcn = drawSolidPolygon;
+                debugDraw.DrawCircleFcn = drawCircle;
+                debugDraw.DrawSolidCircleFcn = drawSolidCircle;
+                debugDraw.DrawSolidCapsuleFcn = drawSolidCapsule;
+                debugDraw.DrawSegmentFcn = drawSegment;
+                debugDraw.DrawTransformFcn = drawTransform;
+                debugDraw.DrawPointFcn = drawPoint;
+                debugDraw.DrawStringFcn = [](auto...) {};
+            } else {
+                debugDraw.DrawPolygon = drawPolygon;
+                debugDraw.DrawSolidPolygon = drawSolidPolygon;
+                debugDraw.DrawCircle = drawCircle;
+                debugDraw.DrawSolidCircle = drawSolidCircle;
+                debugDraw.DrawCapsule = drawSolidCapsule;
+                debugDraw.DrawSolidCapsule = drawSolidCapsule;
+                debugDraw.DrawSegment = drawSegment;
+                debugDraw.DrawTransform = drawTransform;
+                debugDraw.DrawPoint = drawPoint;
+                debugDraw.DrawString = [](auto...) {};
+            }
+
+            debugDraw.drawingBounds = {{view.left(), view.bottom()}, {view.right(), view.top()}};
+            if constexpr(requires { debugDraw.useDrawingBounds; }) {
+                debugDraw.useDrawingBounds = true;
+            }
+
+            debugDraw.drawShapes = bool(_categories & Category::Shapes);
+            debugDraw.drawJoints = bool(_categories & Category::Joints);
+            if constexpr(requires { debugDraw.drawBounds; }) {
+                debugDraw.drawBounds = bool(_categories & Category::Bounds);
+            } else {
+                debugDraw.drawAABBs = bool(_categories & Category::Bounds);
+            }
+            debugDraw.drawMass = bool(_categories & Category::Mass);
+            if constexpr(requires { debugDraw.drawContacts; }) {
+                debugDraw.drawContacts = bool(_categories & Category::Contacts);
+            } else if constexpr(requires { debugDraw.drawContactPoints; }) {
+                debugDraw.drawContactPoints = bool(_categories & Category::Contacts);
+            }
+            if constexpr(requires { debugDraw.drawContactNormals; }) {
+                debugDraw.drawContactNormals = bool(_categories & Category::Contacts);
+            }
+            if constexpr(requires { debugDraw.drawContactImpulses; }) {
+                debugDraw.drawContactImpulses = bool(_categories & Category::Impulses);
+            }
+            if constexpr(requires { debugDraw.drawFrictionImpulses; }) {
+                debugDraw.drawFrictionImpulses = bool(_categories & Category::Impulses);
+            }
+            if constexpr(requires { debugDraw.drawGraphColors; }) {
+                debugDraw.drawGraphColors = bool(_categories & Category::GraphColors);
+            }
+            debugDraw.context = this;
+        }
+
+        FlatShader &_shader;
+        Categories _categories;
+        Float _pixelSize = 1.0f;
+        Vector2 _unitCircle[CircleSegments];
+
+        Containers::Array<Vertex> _lines;
+        Containers::Array<Vertex> _triangles;
+
+        GL::Buffer _lineBuffer;
+        GL::Buffer _triangleBuffer;
+        GL::Mesh _lineMesh;
+        GL::Mesh _triangleMesh;
+    };
+
+    CORRADE_ENUMSET_OPERATORS(DebugDraw::Categories)
+}
+
+#endif //MAGNUM_MOONLANDER_DEBUGDRAW_H
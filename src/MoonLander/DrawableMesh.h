@@ -2,12 +2,12 @@
 #define MAGNUM_MOONLANDER_DRAWABLEMESH_H
 
 #include <Magnum/GL/Mesh.h>
-#include <Magnum/Shaders/Flat.h>
 #include <Magnum/Math/Color.h>
 #include <Magnum/SceneGraph/Camera.h>
 #include <Magnum/SceneGraph/Drawable.h>
 #include <Magnum/SceneGraph/Scene.h>
 
+#include "FlatShader.h"
 #include "Game.h"
 
 namespace Magnum::Game {
@@ -16,7 +16,7 @@ namespace Magnum::Game {
         DrawableMesh(
                 Object2D &object,
                 GL::Mesh& mesh,
-                Shaders::FlatGL2D& shader,
+                FlatShader& shader,
                 const Color4 &color,
                 SceneGraph::DrawableGroup2D &group
                 ) : SceneGraph::Drawable2D{object, &group},
@@ -32,7 +32,7 @@ namespace Magnum::Game {
 
     private:
         GL::Mesh& _mesh;
-        Shaders::FlatGL2D& _shader;
+        FlatShader& _shader;
         Color4 _color;
     };
 }
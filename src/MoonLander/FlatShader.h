@@ -0,0 +1,314 @@
+#ifndef MAGNUM_MOONLANDER_FLATSHADER_H
+#define MAGNUM_MOONLANDER_FLATSHADER_H
+
+#include <utility>
+
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/ArrayView.h>
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Utility/Assert.h>
+
+#include <Magnum/GL/AbstractShaderProgram.h>
+#include <Magnum/GL/OpenGL.h>
+#include <Magnum/GL/Shader.h>
+#include <Magnum/GL/Texture.h>
+#include <Magnum/GL/Version.h>
+#include <Magnum/Math/Color.h>
+#include <Magnum/Math/Matrix3.h>
+#include <Magnum/Shaders/Flat.h>
+
+namespace Magnum::Game {
+    /**
+     * Flat 2D shader, the subset of Shaders::FlatGL2D the game draws with.
+     * Unlike Magnum's shader it can be created from a program binary and
+     * hand its own binary out, which is what ShaderCache keeps on disk.
+     * Attributes and flags are Shaders::FlatGL2D's, so meshes set up for
+     * one work with the other.
+     */
+    class FlatShader: public GL::AbstractShaderProgram {
+    public:
+        using Position = Shaders::FlatGL2D::Position;
+        using TextureCoordinates = Shaders::FlatGL2D::TextureCoordinates;
+        using Color3 = Shaders::FlatGL2D::Color3;
+        using Color4 = Shaders::FlatGL2D::Color4;
+        using TransformationMatrix = Shaders::FlatGL2D::TransformationMatrix;
+
+        using Flag = Shaders::FlatGL2D::Flag;
+        using Flags = Shaders::FlatGL2D::Flags;
+
+        /// Flags this shader implements, others are rejected
+        static constexpr Flags SupportedFlags = Flag::Textured|Flag::TextureTransformation|Flag::VertexColor|
+            Flag::InstancedTransformation;
+
+        /// Compiled but possibly not yet linked shader, see compile()
+        class CompileState;
+
+        /**
+         * Submit compilation and linking of a variant and return without
+         * waiting for either, so drivers with KHR_parallel_shader_compile
+         * can work on several variants at once. With @p retrievableBinary
+         * the driver is asked to keep the linked binary for binary().
+         */
+        static CompileState compile(Flags flags, bool retrievableBinary = false);
+
+        /**
+         * Create from a program binary previously returned by binary().
+         * Drivers reject binaries of another driver version, then this
+         * returns an empty optional and the variant has to be compiled.
+         */
+        static Containers::Optional<FlatShader> fromBinary(Flags flags, GLenum format,
+                                                           Containers::ArrayView<const char> data);
+
+        /// Compile and link, waiting for both
+        explicit FlatShader(const Flags flags = {});
+
+        /// Finish a compile()
+        explicit FlatShader(CompileState &&state);
+
+        explicit FlatShader(NoCreateT) noexcept: GL::AbstractShaderProgram{NoCreate} {}
+
+        FlatShader(const FlatShader &) = delete;
+        FlatShader(FlatShader &&) noexcept = default;
+        FlatShader &operator=(const FlatShader &) = delete;
+        FlatShader &operator=(FlatShader &&) noexcept = default;
+
+        [[nodiscard]] Flags getFlags() const {
+            return _flags;
+        }
+
+        /**
+         * The linked program binary and its driver-specific format, empty
+         * if the driver doesn't keep one
+         */
+        Containers::Array<char> binary(GLenum &format) const {
+            format = GL_NONE;
+#if !defined(MAGNUM_TARGET_GLES2) && !defined(MAGNUM_TARGET_WEBGL)
+            GLint size = 0;
+            glGetProgramiv(id(), GL_PROGRAM_BINARY_LENGTH, &size);
+            Containers::Array<char> data{NoInit, std::size_t(size)};
+            if(size) {
+                GLsizei written = 0;
+                glGetProgramBinary(id(), size, &written, &format, data.data());
+                if(std::size_t(written) != data.size()) return {};
+            }
+            return data;
+#else
+            return {};
+#endif
+        }
+
+        FlatShader &setTransformationProjectionMatrix(const Matrix3 &matrix) {
+            setUniform(_transformationProjectionMatrixUniform, matrix);
+            return *this;
+        }
+
+        /// Expects Flag::TextureTransformation to be set
+        FlatShader &setTextureMatrix(const Matrix3 &matrix) {
+            CORRADE_ASSERT(_flags & Flag::TextureTransformation,
+                "FlatShader::setTextureMatrix(): the shader was not created with texture transformation", *this);
+            setUniform(_textureMatrixUniform, matrix);
+            return *this;
+        }
+
+        FlatShader &setColor(const Magnum::Color4 &color) {
+            setUniform(_colorUniform, color);
+            return *this;
+        }
+
+        /// Expects Flag::Textured to be set
+        FlatShader &bindTexture(GL::Texture2D &texture) {
+            CORRADE_ASSERT(_flags & Flag::Textured,
+                "FlatShader::bindTexture(): the shader was not created with texturing enabled", *this);
+            texture.bind(TextureUnit);
+            return *this;
+        }
+
+        MAGNUM_GL_ABSTRACTSHADERPROGRAM_SUBCLASS_DRAW_IMPLEMENTATION(FlatShader)
+
+    private:
+        static constexpr Int TextureUnit = 0;
+
+        // a program object that's neither linked nor set up yet
+        explicit FlatShader(NoInitT, const Flags flags): _flags(flags) {}
+
+        // after linking or loading a binary, neither keeps uniform values
+        void setup() {
+            _transformationProjectionMatrixUniform = uniformLocation("transformationProjectionMatrix");
+            if(_flags & Flag::TextureTransformation) _textureMatrixUniform = uniformLocation("textureMatrix");
+            _colorUniform = uniformLocation("color");
+            if(_flags & Flag::Textured) setUniform(uniformLocation("textureData"), TextureUnit);
+
+            setTransformationProjectionMatrix(Matrix3{});
+            if(_flags & Flag::TextureTransformation) setTextureMatrix(Matrix3{});
+            setColor(Magnum::Color4{1.0f});
+        }
+
+        Flags _flags;
+        Int _transformationProjectionMatrixUniform = -1;
+        Int _textureMatrixUniform = -1;
+        Int _colorUniform = -1;
+    };
+
+    class FlatShader::CompileState: public FlatShader {
+    private:
+        friend FlatShader;
+
+        explicit CompileState(FlatShader &&shader, GL::Shader &&vert, GL::Shader &&frag):
+            FlatShader{std::move(shader)}, _vert{std::move(vert)}, _frag{std::move(frag)} {}
+
+        GL::Shader _vert;
+        GL::Shader _frag;
+    };
+
+    namespace Implementation {
+        /* Same math as Magnum's Flat.vert and Flat.frag for the flags in
+           FlatShader::SupportedFlags. ShaderCache hashes these, so editing
+           them invalidates cached binaries. */
+        constexpr const char FlatVertexSource[] = R"GLSL(
+#ifdef GL_ES
+precision highp float;
+#endif
+
+uniform mat3 transformationProjectionMatrix;
+#ifdef TEXTURE_TRANSFORMATION
+uniform mat3 textureMatrix;
+#endif
+
+in vec2 position;
+#ifdef TEXTURED
+in vec2 textureCoordinates;
+out vec2 interpolatedTextureCoordinates;
+#endif
+#ifdef VERTEX_COLOR
+in vec4 vertexColor;
+out vec4 interpolatedVertexColor;
+#endif
+#ifdef INSTANCED_TRANSFORMATION
+in mat3 instancedTransformationMatrix;
+#endif
+
+void main() {
+    gl_Position.xywz = vec4(transformationProjectionMatrix*
+#ifdef INSTANCED_TRANSFORMATION
+        instancedTransformationMatrix*
+#endif
+        vec3(position, 1.0), 0.0);
+
+#ifdef TEXTURED
+    interpolatedTextureCoordinates =
+#ifdef TEXTURE_TRANSFORMATION
+        (textureMatrix*vec3(textureCoordinates, 1.0)).xy;
+#else
+        textureCoordinates;
+#endif
+#endif
+#ifdef VERTEX_COLOR
+    interpolatedVertexColor = vertexColor;
+#endif
+}
+)GLSL";
+
+        constexpr const char FlatFragmentSource[] = R"GLSL(
+#ifdef GL_ES
+precision highp float;
+#endif
+
+uniform vec4 color;
+#ifdef TEXTURED
+uniform sampler2D textureData;
+in vec2 interpolatedTextureCoordinates;
+#endif
+#ifdef VERTEX_COLOR
+in vec4 interpolatedVertexColor;
+#endif
+
+out vec4 fragmentColor;
+
+void main() {
+    fragmentColor =
+#ifdef TEXTURED
+        texture(textureData, interpolatedTextureCoordinates)*
+#endif
+#ifdef VERTEX_COLOR
+        interpolatedVertexColor*
+#endif
+        color;
+}
+)GLSL";
+    }
+
+    inline FlatShader::CompileState FlatShader::compile(const Flags flags, const bool retrievableBinary) {
+        CORRADE_ASSERT(!(flags & ~SupportedFlags),
+            "FlatShader::compile(): unsupported flags" << (flags & ~SupportedFlags),
+            (CompileState{FlatShader{NoCreate}, GL::Shader{NoCreate}, GL::Shader{NoCreate}}));
+
+#ifndef MAGNUM_TARGET_GLES
+        constexpr GL::Version version = GL::Version::GL330;
+#else
+        constexpr GL::Version version = GL::Version::GLES300;
+#endif
+        GL::Shader vert{version, GL::Shader::Type::Vertex};
+        GL::Shader frag{version, GL::Shader::Type::Fragment};
+        for(GL::Shader *shader: {&vert, &frag}) {
+            shader->addSource(flags & Flag::Textured ? "#define TEXTURED\n" : "")
+                .addSource(flags & Flag::TextureTransformation ? "#define TEXTURE_TRANSFORMATION\n" : "")
+                .addSource(flags & Flag::VertexColor ? "#define VERTEX_COLOR\n" : "")
+                .addSource(flags & Flag::InstancedTransformation ? "#define INSTANCED_TRANSFORMATION\n" : "");
+        }
+        vert.addSource(Implementation::FlatVertexSource);
+        frag.addSource(Implementation::FlatFragmentSource);
+        vert.submitCompile();
+        frag.submitCompile();
+
+        FlatShader out{NoInit, flags};
+        out.attachShaders({vert, frag});
+        // kept in a binary, so loading one doesn't need them bound again
+        out.bindAttributeLocation(Position::Location, "position");
+        if(flags & Flag::Textured) out.bindAttributeLocation(TextureCoordinates::Location, "textureCoordinates");
+        if(flags & Flag::VertexColor) out.bindAttributeLocation(Color4::Location, "vertexColor");
+        if(flags & Flag::InstancedTransformation) {
+            out.bindAttributeLocation(TransformationMatrix::Location, "instancedTransformationMatrix");
+        }
+#if !defined(MAGNUM_TARGET_GLES2) && !defined(MAGNUM_TARGET_WEBGL)
+        if(retrievableBinary) out.setRetrievableBinary(true);
+#else
+        static_cast<void>(retrievableBinary);
+#endif
+        out.submitLink();
+
+        return CompileState{std::move(out), std::move(vert), std::move(frag)};
+    }
+
+    inline Containers::Optional<FlatShader> FlatShader::fromBinary(const Flags flags, const GLenum format,
+                                                                   const Containers::ArrayView<const char> data) {
+#if !defined(MAGNUM_TARGET_GLES2) && !defined(MAGNUM_TARGET_WEBGL)
+        if(flags & ~SupportedFlags) return {};
+
+        FlatShader out{NoInit, flags};
+        glProgramBinary(out.id(), format, data.data(), GLsizei(data.size()));
+        GLint linked = GL_FALSE;
+        glGetProgramiv(out.id(), GL_LINK_STATUS, &linked);
+        if(!linked) return {};
+
+        out.setup();
+        return Containers::Optional<FlatShader>{std::move(out)};
+#else
+        static_cast<void>(flags);
+        static_cast<void>(format);
+        static_cast<void>(data);
+        return {};
+#endif
+    }
+
+    inline FlatShader::FlatShader(const Flags flags): FlatShader{compile(flags)} {}
+
+    inline FlatShader::FlatShader(CompileState &&state): FlatShader{static_cast<FlatShader&&>(std::move(state))} {
+        // no program if compile() asserted on the flags
+        if(!id()) return;
+
+        CORRADE_INTERNAL_ASSERT_OUTPUT(checkLink({state._vert, state._frag}));
+        setup();
+    }
+}
+
+#endif //MAGNUM_MOONLANDER_FLATSHADER_H
@@ -0,0 +1,116 @@
+#ifndef MAGNUM_MOONLANDER_FLOATINGORIGIN_H
+#define MAGNUM_MOONLANDER_FLOATINGORIGIN_H
+
+#include <Corrade/Utility/Debug.h>
+
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Vector2.h>
+
+#include <box2d/box2d.h>
+
+namespace Magnum::Game {
+    /// Move a body by -@p shift, keeping its rotation, velocity and sleep state
+    inline void shiftBody(const b2BodyId bodyId, const Vector2 &shift) {
+        const b2Transform transform = b2Body_GetTransform(bodyId);
+        b2Body_SetTransform(bodyId, {transform.p.x - shift.x(), transform.p.y - shift.y()}, transform.q);
+    }
+
+    /**
+     * Where the origin of the world, the physics and render space, is in
+     * the level. Positions far from the origin lose precision, so once the
+     * focus, usually the lander, gets too far from it, recenter() moves
+     * the origin next to it and everything in the world has to be shifted
+     * back by the same amount in one go.
+     *
+     * The origin moves in whole cells and is kept as an integer cell
+     * index, so the level can be as large as that index allows without
+     * any doubles. With a power of two cell size the shifts themselves are
+     * exact in floats too, nothing drifts after many of them.
+     */
+    class FloatingOrigin {
+    public:
+        struct Configuration {
+            /// Size of the steps the origin moves in, a power of two
+            Float cellSize = 256.0f;
+            /// How many cells the focus can get away before a shift
+            Int maxCells = 4;
+        };
+
+        FloatingOrigin(): FloatingOrigin{Configuration{}} {}
+
+        explicit FloatingOrigin(const Configuration &configuration): _configuration(configuration) {}
+
+        [[nodiscard]] const Configuration &configuration() const {
+            return _configuration;
+        }
+
+        /// Cell of the level the world origin is in
+        [[nodiscard]] Vector2i getCell() const {
+            return _cell;
+        }
+
+        /**
+         * Where a position authored in level space is in the world now.
+         * Meant for level content near the start, far away positions
+         * should be built from a cell and an offset instead.
+         */
+        [[nodiscard]] Vector2 toWorld(const Vector2 &levelPosition) const {
+            return levelPosition - Vector2{_cell}*_configuration.cellSize;
+        }
+
+        /// Level position of a world position, for display and logs
+        [[nodiscard]] Vector2 toLevel(const Vector2 &worldPosition) const {
+            return worldPosition + Vector2{_cell}*_configuration.cellSize;
+        }
+
+        /**
+         * Move the origin to the cell @p focus is in if it got more than
+         * Configuration::maxCells away on either axis.
+         * @return What to subtract from every position in the world, zero
+         *      if the origin stayed
+         */
+        [[nodiscard]] Vector2 recenter(const Vector2 &focus) {
+            const Vector2i cells{Math::round(focus/_configuration.cellSize)};
+            if(Math::abs(cells).max() <= _configuration.maxCells) return {};
+
+            _cell += cells;
+            return Vector2{cells}*_configuration.cellSize;
+        }
+
+        /// Account a shift that took @p milliseconds and moved @p bodyCount bodies
+        void record(const Double milliseconds, const std::size_t bodyCount) {
+            ++_shiftCount;
+            _lastMilliseconds = milliseconds;
+            _maxMilliseconds = Math::max(_maxMilliseconds, milliseconds);
+            _lastBodyCount = bodyCount;
+        }
+
+        [[nodiscard]] UnsignedLong getShiftCount() const {
+            return _shiftCount;
+        }
+
+        [[nodiscard]] Double getMaxMilliseconds() const {
+            return _maxMilliseconds;
+        }
+
+        void print() const {
+            if(!_shiftCount) return;
+
+            Debug{} << "[origin]" << _shiftCount << "shifts, now at cell" << _cell << Debug::nospace
+                << ", last moved" << _lastBodyCount << "bodies in" << _lastMilliseconds << "ms, worst"
+                << _maxMilliseconds << "ms";
+        }
+
+    private:
+        Configuration _configuration;
+        Vector2i _cell;
+
+        UnsignedLong _shiftCount = 0;
+        std::size_t _lastBodyCount = 0;
+        Double _lastMilliseconds = 0.0;
+        Double _maxMilliseconds = 0.0;
+    };
+}
+
+#endif //MAGNUM_MOONLANDER_FLOATINGORIGIN_H
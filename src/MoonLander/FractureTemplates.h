@@ -0,0 +1,132 @@
+#ifndef MAGNUM_MOONLANDER_FRACTURETEMPLATES_H
+#define MAGNUM_MOONLANDER_FRACTURETEMPLATES_H
+
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Range.h>
+#include <Magnum/Math/Vector2.h>
+
+#include <box2d/box2d.h>
+
+#include "AssetId.h"
+
+namespace Magnum::Game {
+    /**
+     * One piece of a sprite broken apart, in sprite space where the sprite
+     * spans [-1, 1] on both axes like the sprite mesh does.
+     */
+    struct FracturePiece {
+        static constexpr UnsignedInt MaxPoints = B2_MAX_POLYGON_VERTICES;
+
+        /// Convex outline, counterclockwise
+        Vector2 points[MaxPoints]{};
+        UnsignedInt pointCount = 0;
+        /// Center of mass of the outline, the piece's body origin
+        Vector2 centroid;
+        /// Bounds of the outline in texture coordinates of the sprite
+        Range2D textureRectangle;
+        /// Share of the parent's mass
+        Float massFraction = 0.0f;
+    };
+
+    /**
+     * How a sprite breaks, baked at compile time so a crash only has to
+     * look the pieces up. The pieces tile the whole sprite rectangle.
+     */
+    struct FractureTemplate {
+        static constexpr UnsignedInt MaxPieces = 24;
+
+        AssetName sprite;
+        FracturePiece pieces[MaxPieces]{};
+        UnsignedInt pieceCount = 0;
+    };
+
+    namespace Implementation {
+        // deterministic value in [-1, 1], the same on every compiler
+        constexpr Float fractureNoise(UnsignedInt seed) {
+            seed ^= seed >> 16;
+            seed *= 0x7feb352du;
+            seed ^= seed >> 15;
+            seed *= 0x846ca68bu;
+            seed ^= seed >> 16;
+            return Float(seed & 0xffff)/32767.5f - 1.0f;
+        }
+
+        constexpr FracturePiece fracturePiece(const Vector2 *const points, const UnsignedInt count) {
+            FracturePiece piece;
+            piece.pointCount = count;
+
+            Float area = 0.0f, cx = 0.0f, cy = 0.0f;
+            Float minX = 1.0f, minY = 1.0f, maxX = -1.0f, maxY = -1.0f;
+            for(UnsignedInt i = 0; i != count; ++i) {
+                const Vector2 a = points[i];
+                const Vector2 b = points[(i + 1) % count];
+                const Float cross = a.x()*b.y() - b.x()*a.y();
+                area += cross;
+                cx += (a.x() + b.x())*cross;
+                cy += (a.y() + b.y())*cross;
+
+                piece.points[i] = a;
+                minX = a.x() < minX ? a.x() : minX;
+                minY = a.y() < minY ? a.y() : minY;
+                maxX = a.x() > maxX ? a.x() : maxX;
+                maxY = a.y() > maxY ? a.y() : maxY;
+            }
+            area *= 0.5f;
+
+            piece.centroid = Vector2{cx/(6.0f*area), cy/(6.0f*area)};
+            piece.textureRectangle = Range2D{Vector2{(minX + 1.0f)*0.5f, (minY + 1.0f)*0.5f},
+                                             Vector2{(maxX + 1.0f)*0.5f, (maxY + 1.0f)*0.5f}};
+            // the sprite rectangle has an area of 4
+            piece.massFraction = area/4.0f;
+            return piece;
+        }
+    }
+
+    /**
+     * Cut @p sprite along a grid of @p columns × @p rows cells whose inner
+     * corners are moved by up to @p jitter of a cell, which keeps every
+     * cell convex. Some cells are split along a diagonal on top.
+     */
+    constexpr FractureTemplate bakeFracture(const AssetName sprite, const UnsignedInt columns, const UnsignedInt rows,
+                                            const UnsignedInt seed, const Float jitter) {
+        FractureTemplate fracture{sprite};
+
+        const auto corner = [&](const UnsignedInt x, const UnsignedInt y) {
+            const Float cellX = 2.0f/Float(columns);
+            const Float cellY = 2.0f/Float(rows);
+            const bool innerX = x != 0 && x != columns;
+            const bool innerY = y != 0 && y != rows;
+            const UnsignedInt key = seed*7919u + y*(columns + 1) + x;
+            return Vector2{
+                -1.0f + cellX*Float(x) + (innerX ? Implementation::fractureNoise(key*2)*jitter*cellX : 0.0f),
+                -1.0f + cellY*Float(y) + (innerY ? Implementation::fractureNoise(key*2 + 1)*jitter*cellY : 0.0f)};
+        };
+
+        for(UnsignedInt y = 0; y != rows; ++y) {
+            for(UnsignedInt x = 0; x != columns; ++x) {
+                const Vector2 quad[]{corner(x, y), corner(x + 1, y), corner(x + 1, y + 1), corner(x, y + 1)};
+                const bool split = Implementation::fractureNoise(seed*104729u + y*columns + x) > 0.3f &&
+                                   fracture.pieceCount + 2 <= FractureTemplate::MaxPieces;
+                if(split) {
+                    const Vector2 first[]{quad[0], quad[1], quad[2]};
+                    const Vector2 second[]{quad[0], quad[2], quad[3]};
+                    fracture.pieces[fracture.pieceCount++] = Implementation::fracturePiece(first, 3);
+                    fracture.pieces[fracture.pieceCount++] = Implementation::fracturePiece(second, 3);
+                } else if(fracture.pieceCount < FractureTemplate::MaxPieces) {
+                    fracture.pieces[fracture.pieceCount++] = Implementation::fracturePiece(quad, 4);
+                }
+            }
+        }
+
+        return fracture;
+    }
+
+    constexpr FractureTemplate LanderFracture = bakeFracture(Assets::Lander, 3, 3, 1, 0.2f);
+    constexpr FractureTemplate CapsuleFracture = bakeFracture(Assets::Capsule, 3, 2, 2, 0.2f);
+    constexpr FractureTemplate ShipHullFracture = bakeFracture(Assets::ShipHull, 2, 3, 3, 0.2f);
+
+    static_assert(LanderFracture.pieceCount >= 9 && CapsuleFracture.pieceCount >= 6 &&
+                  ShipHullFracture.pieceCount >= 6, "fracture templates lost pieces");
+}
+
+#endif //MAGNUM_MOONLANDER_FRACTURETEMPLATES_H
@@ -0,0 +1,79 @@
+#ifndef MAGNUM_MOONLANDER_FRAMESTATISTICS_H
+#define MAGNUM_MOONLANDER_FRAMESTATISTICS_H
+
+#include <algorithm>
+
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Utility/Debug.h>
+
+#include <Magnum/Magnum.h>
+
+namespace Magnum::Game {
+    /**
+     * Collects per-frame timing samples (in milliseconds) and reports
+     * min / mean / percentiles / max over the whole run.
+     */
+    class FrameStatistics {
+    private:
+        Containers::Array<Double> _samples;
+
+    public:
+        explicit FrameStatistics(const std::size_t expectedCount = 0) {
+            Containers::arrayReserve(_samples, expectedCount);
+        }
+
+        void add(const Double milliseconds) {
+            Containers::arrayAppend(_samples, milliseconds);
+        }
+
+        void clear() {
+            Containers::arrayClear(_samples);
+        }
+
+        [[nodiscard]] std::size_t count() const {
+            return _samples.size();
+        }
+
+        [[nodiscard]] Double sum() const {
+            Double sum = 0.0;
+            for(const Double sample: _samples) sum += sample;
+            return sum;
+        }
+
+        [[nodiscard]] Double mean() const {
+            return _samples.isEmpty() ? 0.0 : sum()/Double(_samples.size());
+        }
+
+        [[nodiscard]] Double min() const {
+            return _samples.isEmpty() ? 0.0 : *std::min_element(_samples.begin(), _samples.end());
+        }
+
+        [[nodiscard]] Double max() const {
+            return _samples.isEmpty() ? 0.0 : *std::max_element(_samples.begin(), _samples.end());
+        }
+
+        /// Nearest-rank percentile, @p percent in range [0, 100]
+        [[nodiscard]] Double percentile(const Double percent) const {
+            if(_samples.isEmpty()) return 0.0;
+
+            Containers::Array<Double> sorted{NoInit, _samples.size()};
+            std::copy(_samples.begin(), _samples.end(), sorted.begin());
+            std::sort(sorted.begin(), sorted.end());
+
+            const auto rank = std::size_t(percent/100.0*Double(sorted.size() - 1) + 0.5);
+            return sorted[std::min(rank, sorted.size() - 1)];
+        }
+
+        void print(const char *label) const {
+            Debug{} << label << "frames:" << count()
+                << "min:" << min() << "ms"
+                << "mean:" << mean() << "ms"
+                << "p50:" << percentile(50.0) << "ms"
+                << "p95:" << percentile(95.0) << "ms"
+                << "p99:" << percentile(99.0) << "ms"
+                << "max:" << max() << "ms";
+        }
+    };
+}
+
+#endif //MAGNUM_MOONLANDER_FRAMESTATISTICS_H
@@ -0,0 +1,380 @@
+#ifndef MAGNUM_MOONLANDER_HUD_H
+#define MAGNUM_MOONLANDER_HUD_H
+
+#include <charconv>
+#include <cstring>
+
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Utility/Assert.h>
+
+#include <Magnum/ImageView.h>
+#include <Magnum/Mesh.h>
+#include <Magnum/PixelFormat.h>
+#include <Magnum/GL/Buffer.h>
+#include <Magnum/GL/Mesh.h>
+#include <Magnum/GL/Texture.h>
+#include <Magnum/GL/TextureFormat.h>
+#include <Magnum/Math/Color.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Matrix3.h>
+
+#include "ShaderCache.h"
+
+namespace Magnum::Game {
+    using namespace Math::Literals;
+
+    /**
+     * Retained telemetry overlay. Text uses a 5x7 bitmap font that is baked
+     * into a glyph cache texture once, every glyph and the thrust vector is
+     * a quad in one vertex buffer, so the whole HUD is a single draw.
+     *
+     * Fields own a fixed range of quads. setValue() formats into a stack
+     * buffer and re-lays out the field only if the displayed text changed;
+     * update() then uploads just the changed range of the buffer. Nothing
+     * allocates after the fields are added.
+     */
+    class Hud {
+    public:
+        /// Most glyphs a HUD can hold, the indices are 16-bit and quad 0 is the thrust vector
+        static constexpr UnsignedInt MaxGlyphCapacity = 65536/4 - 1;
+
+        struct Configuration {
+            /// Screen pixels per font pixel
+            Int glyphScale = 2;
+            /// Top left corner of the first text row, in pixels from the top left of the screen
+            Vector2 origin{12.0f, 12.0f};
+            /// Where the thrust vector starts, in pixels from the top left of the screen
+            Vector2 thrustOrigin{80.0f, 200.0f};
+            /// Pixels per unit of thrust
+            Float thrustScale = 12.0f;
+            Float thrustWidth = 3.0f;
+            Color4 color = 0xe0f0ff_rgbf;
+            /// Glyphs of all fields together, labels included, at most MaxGlyphCapacity
+            UnsignedInt glyphCapacity = 2048;
+        };
+
+        explicit Hud(ShaderCache &shaders, const Vector2i &viewportSize): Hud{shaders, viewportSize, Configuration{}} {}
+
+        explicit Hud(ShaderCache &shaders, const Vector2i &viewportSize, const Configuration &configuration):
+            _configuration(configuration),
+            // same variant as the sprites, the texture matrix is reset on every draw
+            _shader(shaders.flat(FlatShader::Flag::Textured|FlatShader::Flag::TextureTransformation))
+        {
+            CORRADE_INTERNAL_ASSERT(configuration.glyphCapacity <= MaxGlyphCapacity);
+
+            // quad 0 is the thrust vector, glyphs follow
+            const UnsignedInt quadCapacity = configuration.glyphCapacity + 1;
+            _vertices = Containers::Array<Vertex>{ValueInit, quadCapacity*4};
+
+            Containers::Array<UnsignedShort> indices{NoInit, quadCapacity*6};
+            for(UnsignedInt quad = 0; quad != quadCapacity; ++quad) {
+                const UnsignedShort first = UnsignedShort(quad*4);
+                const UnsignedShort quadIndices[]{
+                    first, UnsignedShort(first + 1), UnsignedShort(first + 2),
+                    UnsignedShort(first + 2), UnsignedShort(first + 1), UnsignedShort(first + 3)};
+                std::memcpy(indices.data() + quad*6, quadIndices, sizeof(quadIndices));
+            }
+
+            _vertexBuffer.setData(_vertices, GL::BufferUsage::DynamicDraw);
+            _indexBuffer.setData(indices, GL::BufferUsage::StaticDraw);
+            _mesh.setCount(6)
+                .addVertexBuffer(_vertexBuffer, 0,
+                                 FlatShader::Position{},
+                                 FlatShader::TextureCoordinates{})
+                .setIndexBuffer(_indexBuffer, 0, MeshIndexType::UnsignedShort);
+
+            bakeGlyphCache();
+            setViewportSize(viewportSize);
+        }
+
+        /// Pixel size of the screen the HUD is laid out for
+        void setViewportSize(const Vector2i &size) {
+            // pixels from the top left corner, Y down
+            _projection = Matrix3::translation({-1.0f, 1.0f})*
+                Matrix3::scaling({2.0f/Float(size.x()), -2.0f/Float(size.y())});
+        }
+
+        /**
+         * Add a `LABEL value` text field.
+         * @param label Shown in front of the value, uppercase, has to be a literal
+         * @param row Text row, counted from Configuration::origin
+         * @param column Text column of the label
+         * @param width Characters reserved for the value, it's right-aligned in them
+         * @param precision Decimal places of the value
+         */
+        UnsignedInt addField(const char *label, const Int row, const Int column, const Int width, const Int precision) {
+            const UnsignedInt labelLength = UnsignedInt(std::strlen(label));
+            CORRADE_INTERNAL_ASSERT(width > 0 && width <= Int(sizeof(Field::text)));
+            CORRADE_INTERNAL_ASSERT(_usedQuads + labelLength + 1 + width <= _configuration.glyphCapacity + 1);
+
+            Field field;
+            field.position = _configuration.origin + Vector2{Float(column), Float(row)}*cellSize();
+            field.firstQuad = _usedQuads + labelLength + 1;
+            field.width = width;
+            field.precision = precision;
+
+            // labels never change, lay them out once
+            for(UnsignedInt i = 0; i != labelLength; ++i) {
+                setGlyph(_usedQuads + i, field.position + Vector2::xAxis(Float(i)*cellSize().x()), label[i]);
+            }
+            field.position += Vector2::xAxis(Float(labelLength + 1)*cellSize().x());
+
+            _usedQuads = field.firstQuad + width;
+            _mesh.setCount(Int(_usedQuads*6));
+            Containers::arrayAppend(_fields, field);
+
+            const UnsignedInt id = UnsignedInt(_fields.size() - 1);
+            layoutField(id);
+            return id;
+        }
+
+        /// Update a field, costs a text layout only if the shown digits change
+        void setValue(const UnsignedInt id, const Double value) {
+            Field &field = _fields[id];
+            if(field.valid && field.value == value) return;
+            field.value = value;
+            field.valid = true;
+
+            char text[sizeof(Field::text)];
+            const std::to_chars_result result = std::to_chars(text, text + sizeof(text), value,
+                                                              std::chars_format::fixed, field.precision);
+            Int length = result.ec == std::errc{} ? Int(result.ptr - text) : 0;
+            if(length > field.width || length == 0) {
+                // doesn't fit, show a row of hashes like a spreadsheet would
+                length = field.width;
+                std::memset(text, '#', std::size_t(length));
+            }
+
+            if(length == field.length && std::memcmp(text, field.text, std::size_t(length)) == 0) return;
+
+            std::memcpy(field.text, text, std::size_t(length));
+            field.length = length;
+            layoutField(id);
+        }
+
+        /// Thrust vector, drawn as a line from Configuration::thrustOrigin
+        void setThrust(const Vector2 &thrust) {
+            // Y up in the world, Y down on screen; skip sub-pixel changes
+            const Vector2 end = _configuration.thrustOrigin + Vector2{thrust.x(), -thrust.y()}*_configuration.thrustScale;
+            if((end - _thrustEnd).dot() < 0.25f) return;
+            _thrustEnd = end;
+
+            const Vector2 direction = end - _configuration.thrustOrigin;
+            const Float length = direction.length();
+            const Vector2 side = length > 0.0f ?
+                direction.perpendicular()/length*(_configuration.thrustWidth*0.5f) : Vector2{};
+            const Vector2 uv = _solidTextureCoordinates;
+
+            Vertex *quad = _vertices.data();
+            quad[0] = {_configuration.thrustOrigin - side, uv};
+            quad[1] = {_configuration.thrustOrigin + side, uv};
+            quad[2] = {end - side, uv};
+            quad[3] = {end + side, uv};
+            markDirty(0, 1);
+        }
+
+        /// Upload quads changed since the last call
+        void update() {
+            if(_dirtyEnd <= _dirtyBegin) return;
+
+            _vertexBuffer.setSubData(_dirtyBegin*4*sizeof(Vertex),
+                                     _vertices.slice(_dirtyBegin*4, _dirtyEnd*4));
+            _dirtyBegin = ~UnsignedInt{};
+            _dirtyEnd = 0;
+        }
+
+        void draw() {
+            _shader.setTransformationProjectionMatrix(_projection)
+                .setTextureMatrix(Matrix3{})
+                .setColor(_configuration.color)
+                .bindTexture(_glyphCache)
+                .draw(_mesh);
+        }
+
+        [[nodiscard]] std::size_t getFieldCount() const {
+            return _fields.size();
+        }
+
+        /// Field layouts done since construction, labels not counted
+        [[nodiscard]] UnsignedLong getLayoutCount() const {
+            return _layoutCount;
+        }
+
+    private:
+        // 5x7 glyphs in 8x8 cells, 16 cells per row, ASCII 32 to 95 and a solid cell
+        static constexpr Int CellSize = 8;
+        static constexpr Int AtlasColumns = 16;
+        static constexpr Int SolidCell = 64;
+        static constexpr Vector2i AtlasSize{AtlasColumns*CellSize, 5*CellSize};
+
+        struct Vertex {
+            Vector2 position;
+            Vector2 textureCoordinates;
+        };
+
+        struct Field {
+            Vector2 position;
+            UnsignedInt firstQuad;
+            Int width;
+            Int precision;
+            Int length = 0;
+            Double value = 0.0;
+            bool valid = false;
+            char text[24];
+        };
+
+        struct GlyphBitmap {
+            char character;
+            UnsignedByte rows[7];
+        };
+
+        static constexpr GlyphBitmap Font[]{
+            {'#', {0x0a, 0x0a, 0x1f, 0x0a, 0x1f, 0x0a, 0x0a}},
+            {'%', {0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03}},
+            {'(', {0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02}},
+            {')', {0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08}},
+            {'+', {0x00, 0x04, 0x04, 0x1f, 0x04, 0x04, 0x00}},
+            {'-', {0x00, 0x00, 0x00, 0x1f, 0x00, 0x00, 0x00}},
+            {'.', {0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x0c}},
+            {'/', {0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00}},
+            {'0', {0x0e, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0e}},
+            {'1', {0x04, 0x0c, 0x04, 0x04, 0x04, 0x04, 0x0e}},
+            {'2', {0x0e, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1f}},
+            {'3', {0x1f, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0e}},
+            {'4', {0x02, 0x06, 0x0a, 0x12, 0x1f, 0x02, 0x02}},
+            {'5', {0x1f, 0x10, 0x1e, 0x01, 0x01, 0x11, 0x0e}},
+            {'6', {0x06, 0x08, 0x10, 0x1e, 0x11, 0x11, 0x0e}},
+            {'7', {0x1f, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08}},
+            {'8', {0x0e, 0x11, 0x11, 0x0e, 0x11, 0x11, 0x0e}},
+            {'9', {0x0e, 0x11, 0x11, 0x0f, 0x01, 0x02, 0x0c}},
+            {':', {0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x0c, 0x00}},
+            {'A', {0x0e, 0x11, 0x11, 0x11, 0x1f, 0x11, 0x11}},
+            {'B', {0x1e, 0x11, 0x11, 0x1e, 0x11, 0x11, 0x1e}},
+            {'C', {0x0e, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0e}},
+            {'D', {0x1c, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1c}},
+            {'E', {0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x1f}},
+            {'F', {0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x10}},
+            {'G', {0x0e, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0f}},
+            {'H', {0x11, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11}},
+            {'I', {0x0e, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e}},
+            {'J', {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0c}},
+            {'K', {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11}},
+            {'L', {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1f}},
+            {'M', {0x11, 0x1b, 0x15, 0x15, 0x11, 0x11, 0x11}},
+            {'N', {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11}},
+            {'O', {0x0e, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e}},
+            {'P', {0x1e, 0x11, 0x11, 0x1e, 0x10, 0x10, 0x10}},
+            {'Q', {0x0e, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0d}},
+            {'R', {0x1e, 0x11, 0x11, 0x1e, 0x14, 0x12, 0x11}},
+            {'S', {0x0f, 0x10, 0x10, 0x0e, 0x01, 0x01, 0x1e}},
+            {'T', {0x1f, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}},
+            {'U', {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e}},
+            {'V', {0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x04}},
+            {'W', {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0a}},
+            {'X', {0x11, 0x11, 0x0a, 0x04, 0x0a, 0x11, 0x11}},
+            {'Y', {0x11, 0x11, 0x11, 0x0a, 0x04, 0x04, 0x04}},
+            {'Z', {0x1f, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1f}},
+        };
+
+        [[nodiscard]] Vector2 cellSize() const {
+            // one pixel of spacing between glyphs, three between rows
+            return Vector2{6.0f, 10.0f}*Float(_configuration.glyphScale);
+        }
+
+        static Int cellIndex(char character) {
+            if(character >= 'a' && character <= 'z') character -= 'a' - 'A';
+            if(character < 32 || character > 95) return 0;
+            return character - 32;
+        }
+
+        void bakeGlyphCache() {
+            Containers::Array<Color4ub> pixels{ValueInit, std::size_t(AtlasSize.product())};
+            const auto cellOrigin = [](const Int cell) {
+                return Vector2i{cell % AtlasColumns, cell / AtlasColumns}*CellSize;
+            };
+
+            // glyph rows go top to bottom, texture rows bottom to top
+            for(const GlyphBitmap &glyph: Font) {
+                const Vector2i origin = cellOrigin(cellIndex(glyph.character));
+                for(Int row = 0; row != 7; ++row) {
+                    for(Int column = 0; column != 5; ++column) {
+                        if(!(glyph.rows[row] & (0x10 >> column))) continue;
+                        pixels[(origin.y() + 7 - row)*AtlasSize.x() + origin.x() + column] = 0xffffffff_rgba;
+                    }
+                }
+            }
+
+            const Vector2i solid = cellOrigin(SolidCell);
+            for(Int y = 0; y != CellSize; ++y) {
+                for(Int x = 0; x != CellSize; ++x) {
+                    pixels[(solid.y() + y)*AtlasSize.x() + solid.x() + x] = 0xffffffff_rgba;
+                }
+            }
+            _solidTextureCoordinates = (Vector2{solid} + Vector2{CellSize*0.5f})/Vector2{AtlasSize};
+
+            _glyphCache.setWrapping(GL::SamplerWrapping::ClampToEdge)
+                .setMagnificationFilter(GL::SamplerFilter::Nearest)
+                .setMinificationFilter(GL::SamplerFilter::Nearest)
+                .setStorage(1, GL::TextureFormat::RGBA8, AtlasSize)
+                .setSubImage(0, {}, ImageView2D{PixelFormat::RGBA8Unorm, AtlasSize, pixels});
+        }
+
+        void setGlyph(const UnsignedInt quad, const Vector2 &position, const char character) {
+            const Int cell = cellIndex(character);
+            const Vector2 cellOrigin = Vector2{Vector2i{cell % AtlasColumns, cell / AtlasColumns}*CellSize};
+            const Vector2 min = cellOrigin/Vector2{AtlasSize};
+            const Vector2 max = (cellOrigin + Vector2{5.0f, 8.0f})/Vector2{AtlasSize};
+            const Vector2 size = Vector2{5.0f, 7.0f}*Float(_configuration.glyphScale);
+
+            Vertex *vertices = _vertices.data() + quad*4;
+            vertices[0] = {position, {min.x(), max.y()}};
+            vertices[1] = {position + Vector2::yAxis(size.y()), {min.x(), min.y() + 1.0f/AtlasSize.y()}};
+            vertices[2] = {position + Vector2::xAxis(size.x()), {max.x(), max.y()}};
+            vertices[3] = {position + size, {max.x(), min.y() + 1.0f/AtlasSize.y()}};
+            markDirty(quad, quad + 1);
+        }
+
+        void layoutField(const UnsignedInt id) {
+            const Field &field = _fields[id];
+
+            // right-aligned, leading cells are spaces so stale digits disappear
+            const Int padding = field.width - field.length;
+            for(Int i = 0; i != field.width; ++i) {
+                const char character = i < padding ? ' ' : field.text[i - padding];
+                setGlyph(field.firstQuad + UnsignedInt(i),
+                         field.position + Vector2::xAxis(Float(i)*cellSize().x()), character);
+            }
+
+            ++_layoutCount;
+        }
+
+        void markDirty(const UnsignedInt begin, const UnsignedInt end) {
+            _dirtyBegin = Math::min(_dirtyBegin, begin);
+            _dirtyEnd = Math::max(_dirtyEnd, end);
+        }
+
+        Configuration _configuration;
+        FlatShader &_shader;
+        Matrix3 _projection;
+
+        Containers::Array<Vertex> _vertices;
+        Containers::Array<Field> _fields;
+        // quad 0 is the thrust vector
+        UnsignedInt _usedQuads = 1;
+        // quads waiting for upload
+        UnsignedInt _dirtyBegin = ~UnsignedInt{};
+        UnsignedInt _dirtyEnd = 0;
+        UnsignedLong _layoutCount = 0;
+
+        Vector2 _thrustEnd{};
+        Vector2 _solidTextureCoordinates;
+
+        GL::Buffer _vertexBuffer;
+        GL::Buffer _indexBuffer;
+        GL::Mesh _mesh;
+        GL::Texture2D _glyphCache;
+    };
+}
+
+#endif //MAGNUM_MOONLANDER_HUD_H
@@ -0,0 +1,121 @@
+#ifndef MAGNUM_MOONLANDER_INSTANCEDSHAPES_H
+#define MAGNUM_MOONLANDER_INSTANCEDSHAPES_H
+
+#include <unordered_map>
+
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Containers/Pointer.h>
+
+#include <Magnum/GL/Buffer.h>
+#include <Magnum/GL/Mesh.h>
+#include <Magnum/Math/Color.h>
+#include <Magnum/Math/Matrix3.h>
+
+#include <box2d/box2d.h>
+
+#include "FloatingOrigin.h"
+#include "MeshCache.h"
+#include "ShaderCache.h"
+
+namespace Magnum::Game {
+    /**
+     * Bodies drawn without a scene graph object each, one instanced draw
+     * per cached mesh. Transformations are read from Box2D and streamed
+     * into a per-mesh instance buffer every draw.
+     */
+    class InstancedShapes {
+    public:
+        static constexpr ShaderCache::Flags ShaderFlags =
+            FlatShader::Flag::InstancedTransformation|FlatShader::Flag::VertexColor;
+
+        explicit InstancedShapes(ShaderCache &shaders): _shader(shaders.flat(ShaderFlags)) {}
+
+        void add(const b2BodyId bodyId, MeshCache::Entry &mesh, const Color3 &color) {
+            auto found = _batches.find(&mesh);
+            if(found == _batches.end()) {
+                found = _batches.emplace(&mesh, Containers::pointer<Batch>(mesh)).first;
+            }
+
+            Batch &batch = *found->second;
+            Containers::arrayAppend(batch.bodies, bodyId);
+            Containers::arrayAppend(batch.instances, Instance{Matrix3{}, color});
+            ++_count;
+        }
+
+        [[nodiscard]] std::size_t getCount() const {
+            return _count;
+        }
+
+        /// Draw calls per draw(), one per distinct mesh
+        [[nodiscard]] std::size_t getBatchCount() const {
+            return _batches.size();
+        }
+
+        /// Instance data uploaded to the GPU
+        [[nodiscard]] std::size_t getGpuBytes() const {
+            std::size_t bytes = 0;
+            for(const auto &batch: _batches) bytes += batch.second->uploadedBytes;
+            return bytes;
+        }
+
+        /// Move every body by -@p shift, returns how many there are
+        std::size_t shiftOrigin(const Vector2 &shift) {
+            for(auto &entry: _batches) {
+                for(const b2BodyId bodyId: entry.second->bodies) shiftBody(bodyId, shift);
+            }
+            return _count;
+        }
+
+        void draw(const Matrix3 &transformationProjectionMatrix) {
+            _shader.setTransformationProjectionMatrix(transformationProjectionMatrix)
+                .setColor(Color3{1.0f});
+
+            for(auto &entry: _batches) {
+                Batch &batch = *entry.second;
+                for(std::size_t i = 0; i != batch.bodies.size(); ++i) {
+                    const b2Transform transform = b2Body_GetTransform(batch.bodies[i]);
+                    batch.instances[i].transformation = Matrix3{
+                        {transform.q.c, transform.q.s, 0.0f},
+                        {-transform.q.s, transform.q.c, 0.0f},
+                        {transform.p.x, transform.p.y, 1.0f}};
+                }
+
+                // orphan and refill, the driver doesn't have to wait for the previous frame
+                batch.instanceBuffer.setData(batch.instances, GL::BufferUsage::StreamDraw);
+                batch.uploadedBytes = batch.instances.size()*sizeof(Instance);
+                batch.mesh.setInstanceCount(Int(batch.instances.size()));
+                _shader.draw(batch.mesh);
+            }
+        }
+
+    private:
+        struct Instance {
+            Matrix3 transformation;
+            Color3 color;
+        };
+
+        struct Batch {
+            explicit Batch(MeshCache::Entry &entry) {
+                // shares the cached vertex buffer, only the instance buffer is per batch
+                mesh.setPrimitive(GL::MeshPrimitive::TriangleFan)
+                    .setCount(Int(entry.vertexCount))
+                    .addVertexBuffer(entry.vertices, 0, FlatShader::Position{})
+                    .addVertexBufferInstanced(instanceBuffer, 1, 0,
+                                              FlatShader::TransformationMatrix{},
+                                              FlatShader::Color3{});
+            }
+
+            GL::Buffer instanceBuffer;
+            GL::Mesh mesh;
+            Containers::Array<b2BodyId> bodies;
+            Containers::Array<Instance> instances;
+            std::size_t uploadedBytes = 0;
+        };
+
+        FlatShader &_shader;
+        std::unordered_map<const MeshCache::Entry*, Containers::Pointer<Batch>> _batches;
+        std::size_t _count = 0;
+    };
+}
+
+#endif //MAGNUM_MOONLANDER_INSTANCEDSHAPES_H
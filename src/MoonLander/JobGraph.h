@@ -0,0 +1,288 @@
+#ifndef MAGNUM_MOONLANDER_JOBGRAPH_H
+#define MAGNUM_MOONLANDER_JOBGRAPH_H
+
+#include <atomic>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <thread>
+
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Utility/Debug.h>
+
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Functions.h>
+
+#include "Trace.h"
+#include "WorkerPool.h"
+
+namespace Magnum::Game {
+    /**
+     * The work of a frame as jobs declaring which resources they read and
+     * write. A job runs after the last job declared before it that writes
+     * something it reads or writes, and after every reader since that
+     * write, so declaration order is the serial order and everything else
+     * is free to overlap on a WorkerPool.
+     *
+     * Every run measures the jobs; print() reports the dependencies and the
+     * critical path through them, the chain of jobs that decides how long
+     * the frame takes no matter how many threads there are.
+     */
+    class JobGraph {
+    public:
+        enum class Affinity: UnsignedByte {
+            /// Any thread of the pool
+            Any,
+            /// The thread calling run(), for GL and windowing calls
+            MainThread
+        };
+
+        /// Name of a piece of frame state, has to be a literal
+        UnsignedInt addResource(const char *name) {
+            Containers::arrayAppend(_resources, Resource{name});
+            return UnsignedInt(_resources.size() - 1);
+        }
+
+        /**
+         * Add a job after every job added so far. A resource in @p writes
+         * doesn't need to be in @p reads as well. The name has to be a
+         * literal, it's used for trace spans.
+         */
+        UnsignedInt addJob(const char *name, const std::initializer_list<UnsignedInt> reads,
+                           const std::initializer_list<UnsignedInt> writes, std::function<void()> function,
+                           const Affinity affinity = Affinity::Any) {
+            const UnsignedInt id = UnsignedInt(_jobs.size());
+            Containers::arrayAppend(_jobs, InPlaceInit);
+            Job &job = _jobs[id];
+            job.name = name;
+            job.function = std::move(function);
+            job.affinity = affinity;
+
+            for(const UnsignedInt resource: reads) {
+                if(_resources[resource].lastWriter != NoJob) {
+                    addDependency(id, _resources[resource].lastWriter, resource);
+                }
+            }
+            for(const UnsignedInt resource: writes) {
+                Resource &r = _resources[resource];
+                if(r.lastWriter != NoJob) addDependency(id, r.lastWriter, resource);
+                for(const UnsignedInt reader: r.readers) addDependency(id, reader, resource);
+                r.lastWriter = id;
+                Containers::arrayClear(r.readers);
+            }
+            for(const UnsignedInt resource: reads) {
+                Containers::arrayAppend(_resources[resource].readers, id);
+            }
+
+            return id;
+        }
+
+        [[nodiscard]] std::size_t getJobCount() const {
+            return _jobs.size();
+        }
+
+        [[nodiscard]] UnsignedLong getRunCount() const {
+            return _runs;
+        }
+
+        /// Run every job once, returns after the last one finished
+        void run(WorkerPool &pool) {
+            Trace::Scope traceScope{"JobGraph::run"};
+
+            if(_remaining.size() != _jobs.size()) {
+                _remaining = Containers::Array<std::atomic<UnsignedInt>>{ValueInit, _jobs.size()};
+            }
+
+            _pool = &pool;
+            _finished.store(0, std::memory_order_relaxed);
+            for(std::size_t i = 0; i != _jobs.size(); ++i) {
+                _remaining[i].store(UnsignedInt(_jobs[i].dependencies.size()), std::memory_order_relaxed);
+            }
+
+            const UnsignedLong begin = Trace::now();
+            for(std::size_t i = 0; i != _jobs.size(); ++i) {
+                if(_jobs[i].dependencies.isEmpty()) schedule(UnsignedInt(i));
+            }
+
+            // main thread jobs first, then help the workers
+            while(_finished.load(std::memory_order_acquire) != _jobs.size()) {
+                UnsignedInt job;
+                if(popMainThreadJob(job)) execute(job);
+                else if(!pool.runQueuedTask()) std::this_thread::yield();
+            }
+            // the last worker job may still be returning from execute()
+            pool.wait(_group);
+            const UnsignedLong end = Trace::now();
+
+            for(Job &job: _jobs) {
+                const Double milliseconds = Double(job.end - job.begin)/1.0e6;
+                job.totalMilliseconds += milliseconds;
+                job.maxMilliseconds = Math::max(job.maxMilliseconds, milliseconds);
+            }
+            const Double milliseconds = Double(end - begin)/1.0e6;
+            _totalMilliseconds += milliseconds;
+            _maxMilliseconds = Math::max(_maxMilliseconds, milliseconds);
+            ++_runs;
+        }
+
+        /**
+         * Print every job with its mean and worst time, what it waits for
+         * and how much later it could finish without delaying the frame.
+         * Jobs on the critical path are marked with a star, they have no
+         * such slack.
+         */
+        void print() const {
+            if(!_runs) return;
+
+            // declaration order is a topological order, dependencies are always earlier jobs
+            Containers::Array<Double> finish{ValueInit, _jobs.size()};
+            Containers::Array<UnsignedInt> criticalDependency{DirectInit, _jobs.size(), NoJob};
+            Double criticalLength = 0.0;
+            UnsignedInt criticalEnd = NoJob;
+            Double sum = 0.0;
+            for(std::size_t i = 0; i != _jobs.size(); ++i) {
+                Double start = 0.0;
+                for(const Dependency &dependency: _jobs[i].dependencies) {
+                    if(finish[dependency.job] > start) {
+                        start = finish[dependency.job];
+                        criticalDependency[i] = dependency.job;
+                    }
+                }
+                finish[i] = start + mean(_jobs[i]);
+                sum += mean(_jobs[i]);
+                if(finish[i] >= criticalLength) {
+                    criticalLength = finish[i];
+                    criticalEnd = UnsignedInt(i);
+                }
+            }
+
+            Containers::Array<Double> latestFinish{DirectInit, _jobs.size(), criticalLength};
+            for(std::size_t i = _jobs.size(); i-- != 0; ) {
+                for(const Dependency &dependency: _jobs[i].dependencies) {
+                    latestFinish[dependency.job] = Math::min(latestFinish[dependency.job],
+                                                             latestFinish[i] - mean(_jobs[i]));
+                }
+            }
+
+            Containers::Array<bool> critical{ValueInit, _jobs.size()};
+            for(UnsignedInt i = criticalEnd; i != NoJob; i = criticalDependency[i]) critical[i] = true;
+
+            const Double wall = _totalMilliseconds/Double(_runs);
+            Debug{} << "[jobs]" << _jobs.size() << "jobs over" << _runs << "frames on"
+                << (_pool ? _pool->getThreadCount() : 1) << "threads, mean" << wall << "ms, worst"
+                << _maxMilliseconds << "ms, jobs sum" << sum << "ms, critical path" << criticalLength << "ms";
+            for(std::size_t i = 0; i != _jobs.size(); ++i) {
+                const Job &job = _jobs[i];
+                Debug d;
+                d << (critical[i] ? "  *" : "   ") << job.name << "mean" << mean(job) << "ms, worst"
+                    << job.maxMilliseconds << "ms, slack" << Math::max(latestFinish[i] - finish[i], 0.0) << "ms";
+                if(job.affinity == Affinity::MainThread) d << Debug::nospace << ", main thread";
+                if(job.dependencies.isEmpty()) continue;
+
+                d << Debug::nospace << ", after";
+                for(std::size_t j = 0; j != job.dependencies.size(); ++j) {
+                    const Dependency &dependency = job.dependencies[j];
+                    d << _jobs[dependency.job].name << Debug::nospace << "("
+                        << Debug::nospace << _resources[dependency.resource].name << Debug::nospace
+                        << (j + 1 == job.dependencies.size() ? ")" : "),");
+                }
+            }
+        }
+
+    private:
+        static constexpr UnsignedInt NoJob = ~UnsignedInt{};
+
+        struct Resource {
+            const char *name;
+            UnsignedInt lastWriter = NoJob;
+            // read since the last write
+            Containers::Array<UnsignedInt> readers;
+        };
+
+        struct Dependency {
+            UnsignedInt job;
+            // the first shared resource that made it one, for the report
+            UnsignedInt resource;
+        };
+
+        struct Job {
+            const char *name = nullptr;
+            std::function<void()> function;
+            Affinity affinity = Affinity::Any;
+            Containers::Array<Dependency> dependencies;
+            Containers::Array<UnsignedInt> dependents;
+
+            // last run, in Trace::now() nanoseconds
+            UnsignedLong begin = 0, end = 0;
+            Double totalMilliseconds = 0.0, maxMilliseconds = 0.0;
+        };
+
+        Double mean(const Job &job) const {
+            return job.totalMilliseconds/Double(_runs);
+        }
+
+        void addDependency(const UnsignedInt job, const UnsignedInt on, const UnsignedInt resource) {
+            if(job == on) return;
+            for(const Dependency &dependency: _jobs[job].dependencies) {
+                if(dependency.job == on) return;
+            }
+
+            Containers::arrayAppend(_jobs[job].dependencies, Dependency{on, resource});
+            Containers::arrayAppend(_jobs[on].dependents, job);
+        }
+
+        void schedule(const UnsignedInt job) {
+            if(_jobs[job].affinity == Affinity::MainThread) {
+                std::lock_guard<std::mutex> lock{_mainThreadMutex};
+                Containers::arrayAppend(_mainThreadJobs, job);
+                return;
+            }
+
+            _pool->submit(_group, [](void *context, const UnsignedInt begin, UnsignedInt, UnsignedInt) {
+                static_cast<JobGraph*>(context)->execute(begin);
+            }, this, job, job + 1);
+        }
+
+        bool popMainThreadJob(UnsignedInt &job) {
+            std::lock_guard<std::mutex> lock{_mainThreadMutex};
+            if(_mainThreadHead == _mainThreadJobs.size()) return false;
+
+            job = _mainThreadJobs[_mainThreadHead++];
+            if(_mainThreadHead == _mainThreadJobs.size()) {
+                Containers::arrayClear(_mainThreadJobs);
+                _mainThreadHead = 0;
+            }
+            return true;
+        }
+
+        void execute(const UnsignedInt id) {
+            Job &job = _jobs[id];
+            job.begin = Trace::now();
+            job.function();
+            job.end = Trace::now();
+            if(Trace::isEnabled()) Trace::span(job.name, job.begin, job.end);
+
+            for(const UnsignedInt dependent: job.dependents) {
+                if(_remaining[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1) schedule(dependent);
+            }
+            _finished.fetch_add(1, std::memory_order_release);
+        }
+
+        Containers::Array<Resource> _resources;
+        Containers::Array<Job> _jobs;
+
+        WorkerPool *_pool = nullptr;
+        WorkerPool::TaskGroup _group;
+        Containers::Array<std::atomic<UnsignedInt>> _remaining;
+        std::atomic<std::size_t> _finished{0};
+        std::mutex _mainThreadMutex;
+        Containers::Array<UnsignedInt> _mainThreadJobs;
+        std::size_t _mainThreadHead = 0;
+
+        UnsignedLong _runs = 0;
+        Double _totalMilliseconds = 0.0;
+        Double _maxMilliseconds = 0.0;
+    };
+}
+
+#endif //MAGNUM_MOONLANDER_JOBGRAPH_H
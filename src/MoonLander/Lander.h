@@ -17,6 +17,10 @@ namespace Magnum::Game {
         Vector2 _thrusterForce = {0.0f, 0.0f};
         Vector2 _thrusterImpulse = {0.0f, 0.0f};
 
+        Float _fuel = 100.0f;
+        // fuel burnt per second and unit of thruster force
+        Float _fuelBurnRate = 2.0f;
+
         void thrusterForceToCenter(Vector2 force, const b2BodyId bodyId) const
         {
             b2Body_ApplyForceToCenter(bodyId, b2Vec2{force.x(), force.y()}, true);
@@ -43,17 +47,54 @@ namespace Magnum::Game {
             return _object;
         }
 
-        void update(const Float dt, const b2BodyId bodyId) const
+        /// Remaining fuel, the thrusters stop once it's gone
+        [[nodiscard]] Float getFuel() const {
+            return _fuel;
+        }
+
+        void setFuel(const Float fuel) {
+            _fuel = fuel;
+        }
+
+        /// Thruster force currently applied
+        [[nodiscard]] Vector2 getThrust() const {
+            return _fuel > 0.0f ? _thrusterForce : Vector2{};
+        }
+
+        void update(const Float dt, const b2BodyId bodyId)
         {
-            thrusterForceToCenter(_thrusterForce/dt, bodyId);
+            applyThrust(dt, bodyId);
+            syncObject(bodyId);
+        }
+
+        /// Apply the thruster force for the next world step and burn fuel
+        void applyThrust(const Float dt, const b2BodyId bodyId)
+        {
+            // the exhaust only animates while the engine fires
+            if(const bool firing = !getThrust().isZero(); firing != _engineEffectAnimation.isPlaying()) {
+                if(firing) _engineEffectAnimation.resume();
+                else _engineEffectAnimation.pause();
+            }
+
+            if(_fuel > 0.0f) {
+                thrusterForceToCenter(_thrusterForce/dt, bodyId);
+                _fuel = Math::max(_fuel - _thrusterForce.length()*_fuelBurnRate*dt, 0.0f);
+            }
             // thrusterImpulseToCenter(_thrusterImpulse/dt);
+        }
 
+        /// Copy the body transformation to the scene graph object
+        void syncObject(const b2BodyId bodyId) const
+        {
             auto [x, y] = b2Body_GetPosition(bodyId);
             const Float angle = b2Rot_GetAngle(b2Body_GetRotation(bodyId));
 
             (static_cast<Object2D*>(b2Body_GetUserData(bodyId)))
             ->setTranslation({x, y}).setRotation(Complex::rotation(Rad{angle}));
+        }
 
+        void setForce(const Vector2 &force) {
+            _thrusterForce = force;
         }
 
         void addForceX(const Float force) {
@@ -0,0 +1,170 @@
+#ifndef MAGNUM_MOONLANDER_LATENCYTRACKER_H
+#define MAGNUM_MOONLANDER_LATENCYTRACKER_H
+
+#include <chrono>
+#include <thread>
+
+#include <Corrade/Utility/Debug.h>
+
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Functions.h>
+
+#include "FrameStatistics.h"
+#include "Trace.h"
+
+namespace Magnum::Game {
+    /**
+     * Input-to-present latency. The first input after a present is
+     * timestamped, consumed() marks the tick that applied it and
+     * presented() the buffer swap that showed its effect.
+     *
+     * Timestamps are in the SDL millisecond clock, so the time an event
+     * spends queued before the application sees it is included.
+     */
+    class LatencyTracker {
+    public:
+        explicit LatencyTracker(const std::size_t expectedSamples = 4096): _samples{expectedSamples} {}
+
+        /// Input arrived at @p timestamp, the same event may be reported more than once
+        void input(const UnsignedInt timestamp) {
+            if(_hasInput && timestamp <= _lastInput) return;
+            _hasInput = true;
+            _lastInput = timestamp;
+            if(!_pending) {
+                _pending = true;
+                _pendingTimestamp = timestamp;
+            }
+        }
+
+        /// The tick that's about to run applies the input received so far
+        void consumed() {
+            if(!_pending || _inFlight) return;
+            _inFlight = true;
+            _inFlightTimestamp = _pendingTimestamp;
+            _pending = false;
+        }
+
+        /// A frame drawn after the last consumed() was presented at @p timestamp
+        void presented(const UnsignedInt timestamp) {
+            if(!_inFlight) return;
+            _inFlight = false;
+
+            const Double latency = Double(timestamp - _inFlightTimestamp);
+            _samples.add(latency);
+            Trace::counter("input latency ms", latency);
+        }
+
+        [[nodiscard]] const FrameStatistics &statistics() const {
+            return _samples;
+        }
+
+        void print(const char *label) const {
+            if(!_samples.count()) {
+                Debug{} << label << "no input recorded";
+                return;
+            }
+            _samples.print(label);
+        }
+
+    private:
+        FrameStatistics _samples;
+
+        bool _hasInput = false;
+        UnsignedInt _lastInput = 0;
+
+        bool _pending = false;
+        UnsignedInt _pendingTimestamp = 0;
+
+        bool _inFlight = false;
+        UnsignedInt _inFlightTimestamp = 0;
+    };
+
+    /**
+     * Adaptive frame pacing. Instead of sleeping a fixed minimal period
+     * after a frame, wait() sleeps until just before the work of the next
+     * frame has to start to hit the target period, so input is sampled as
+     * late as possible. The work time is predicted from the frames before.
+     */
+    class FramePacer {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        struct Configuration {
+            /// Frame period to pace to, zero doesn't wait at all
+            Double periodMilliseconds = 1000.0/60.0;
+            /// Slack for scheduler wake-up jitter
+            Double marginMilliseconds = 1.0;
+            /// Weight of the newest frame in the work time prediction
+            Double smoothing = 0.1;
+        };
+
+        FramePacer(): FramePacer{Configuration{}} {}
+
+        explicit FramePacer(const Configuration &configuration): _configuration(configuration) {}
+
+        /**
+         * Sleep until the next frame's work should start. A tick that
+         * ended without frameDone(), because on-demand rendering had
+         * nothing to draw, still used up its frame period, so the deadline
+         * moves on by one period and an idle game sleeps instead of
+         * spinning.
+         */
+        void wait() {
+            const Clock::time_point now = Clock::now();
+            if(_configuration.periodMilliseconds <= 0.0) {
+                _workBegin = now;
+                return;
+            }
+
+            if(_frameOpen) {
+                _deadline = (_deadline == Clock::time_point{} ? now : _deadline) + milliseconds(_configuration.periodMilliseconds);
+            }
+            _frameOpen = true;
+
+            if(_deadline == Clock::time_point{}) {
+                _workBegin = now;
+                return;
+            }
+
+            // fell behind, don't try to catch up with a burst of frames
+            if(_deadline < now) _deadline = now;
+
+            const Clock::time_point wakeUp = _deadline - milliseconds(_predictedWork + _configuration.marginMilliseconds);
+            if(wakeUp > now) {
+                Trace::Scope traceScope{"FramePacer::wait"};
+                std::this_thread::sleep_until(wakeUp);
+            }
+
+            _workBegin = Clock::now();
+        }
+
+        /// Frame done, after the buffer swap
+        void frameDone() {
+            const Clock::time_point now = Clock::now();
+            const Double work = std::chrono::duration<Double, std::milli>(now - _workBegin).count();
+            _predictedWork = _predictedWork == 0.0 ? work : Math::lerp(_predictedWork, work, _configuration.smoothing);
+
+            _deadline = (_deadline == Clock::time_point{} ? now : _deadline) + milliseconds(_configuration.periodMilliseconds);
+            _frameOpen = false;
+            Trace::counter("predicted frame work ms", _predictedWork);
+        }
+
+        [[nodiscard]] Double predictedWorkMilliseconds() const {
+            return _predictedWork;
+        }
+
+    private:
+        static Clock::duration milliseconds(const Double value) {
+            return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<Double, std::milli>(value));
+        }
+
+        Configuration _configuration;
+        Clock::time_point _deadline{};
+        Clock::time_point _workBegin{};
+        Double _predictedWork = 0.0;
+        // wait() was called and frameDone() not yet
+        bool _frameOpen = false;
+    };
+}
+
+#endif //MAGNUM_MOONLANDER_LATENCYTRACKER_H
@@ -3,16 +3,25 @@
 
 #include <box2d/box2d.h>
 #include <Magnum/Math/DualComplex.h>
-#include <Magnum/Shaders/Flat.h>
+#include <Magnum/Math/Range.h>
 #include <Magnum/MeshTools/Compile.h>
 #include <Magnum/SceneGraph/Drawable.h>
 #include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Containers/Pointer.h>
 
 #include "Game.h"
 #include "DrawableMesh.h"
 #include "Sprite.h"
 #include "Lander.h"
 #include "Box.h"
+#include "Terrain.h"
+#include "ShaderCache.h"
+#include "Collision.h"
+#include "FloatingOrigin.h"
+#include "BodyShape.h"
+#include "MeshCache.h"
+#include "InstancedShapes.h"
+#include "Trace.h"
 
 namespace Magnum::Game {
     using namespace Math::Literals;
@@ -41,9 +50,10 @@ namespace Magnum::Game {
         const b2WorldId worldId,
         Object2D *object,
         const DualComplex &transformation,
-        const Vector2 &size,
+        const BodyShape &shape,
         const b2BodyType type,
-        const Float density
+        const Float density,
+        const CollisionFilter &filter
         )
     {
         b2BodyDef bodyDefinition = b2DefaultBodyDef();
@@ -57,97 +67,418 @@ namespace Magnum::Game {
 
         // bodies.emplace(bodyId, bodyDefinition);
 
-        const b2Polygon shape = b2MakeBox(size.x(), size.y());
-        const b2ShapeDef shapeDef = b2DefaultShapeDef();
+        b2ShapeDef shapeDef = b2DefaultShapeDef();
+        filter.apply(shapeDef);
+        // moving bodies report impacts, the terrain carves craters from them
+        shapeDef.enableHitEvents = type == b2_dynamicBody;
         // Set friction after shape creation
 
-        const b2ShapeId shapeId = b2CreatePolygonShape(bodyId, &shapeDef, &shape);
+        const b2ShapeId shapeId = shape.create(bodyId, shapeDef);
         b2Shape_SetFriction(shapeId, BodyDefault::friction);
         b2Shape_SetDensity(shapeId, density, true);
 
         return bodyId;
     }
 
+    /// Box body, @p size is the half size
+    inline b2BodyId newWorldObjectBody(
+        const b2WorldId worldId,
+        Object2D *object,
+        const DualComplex &transformation,
+        const Vector2 &size,
+        const b2BodyType type,
+        const Float density,
+        const CollisionFilter &filter
+        )
+    {
+        return newWorldObjectBody(worldId, object, transformation, BodyShape::box(size), type, density, filter);
+    }
+
 
     class Level {
     private:
         Scene2D& _scene;
 
-        Shaders::FlatGL2D _shader{};
+        FlatShader &_shader;
         GL::Mesh _mesh{NoCreate};
 
+        // before the instanced batches, they reference its meshes
+        MeshCache _meshes;
+        InstancedShapes _instanced;
+        Containers::Array<b2BodyId> _rockBodies;
+
         SceneGraph::DrawableGroup2D _boxGroup;
         SceneGraph::DrawableGroup2D _groundGroup;
 
         b2WorldId _worldId;
         Array<Box*> _boxes{0};
-        Optional<Box*> _ground{};
+        Containers::Pointer<Terrain> _terrain;
+        Box *_landingPad = nullptr;
+
+        // axis-aligned static boxes bakeStaticGeometry() may merge
+        struct StaticBox {
+            Box *box;
+            Vector2 center;
+            Vector2 halfSize;
+        };
+        Array<StaticBox> _staticBoxes;
+        Array<b2BodyId> _bakedBodies;
+        // static bodies of _groundGroup objects, the ones bakeStaticGeometry() replaced are invalid
+        Array<b2BodyId> _staticBodies;
+
+        FloatingOrigin _origin;
+        // bumped whenever something in _groundGroup changes
+        UnsignedLong _staticRevision = 0;
     public:
-        Level(Scene2D &scene, const b2WorldId worldId): _scene(scene), _worldId(worldId) {
+        Level(Scene2D &scene, const b2WorldId worldId, ShaderCache &shaders):
+            _scene(scene), _shader(shaders.flat({})), _instanced(shaders), _worldId(worldId) {
             _mesh = MeshTools::compile(Primitives::squareSolid());
         }
 
         Box *newBox(SceneGraph::DrawableGroup2D &drawable_group, DualComplex transformation,
                     Vector2 size, Color4 color = ObjectDefault::color,
-                    Float density = BodyDefault::density);
+                    Float density = BodyDefault::density,
+                    const CollisionFilter &filter = CollisionFilter::box());
 
         Box *newBoxStatic(SceneGraph::DrawableGroup2D &drawable_group, DualComplex transformation,
-                          Vector2 size, Color4 color);
+                          Vector2 size, Color4 color,
+                          const CollisionFilter &filter = CollisionFilter::staticGeometry());
+
+        /// Body of any shape, drawn with a mesh from the mesh cache
+        Box *newShape(SceneGraph::DrawableGroup2D &drawable_group, const DualComplex &transformation,
+                      const BodyShape &shape, const Color4 &color, b2BodyType type, Float density,
+                      const CollisionFilter &filter);
 
         void initialize() {
-            _ground = newBoxStatic(
-                    _groundGroup,
-                    DualComplex::translation(Vector2::yAxis(-10.0f)),
-                    {20.0f, 1.0f},
-                    0xa5c9ea_rgbf);
+            const Terrain::Configuration terrainConfiguration;
+            _terrain.emplace(_worldId, terrainConfiguration);
+
+            const auto terrainObject = new Object2D{&_scene};
+            new DrawableMesh{*terrainObject, _terrain->getMesh(), _shader, 0xa5c9ea_rgbf, _groundGroup};
+
+            _landingPad = addLandingPad({8.0f, terrainConfiguration.surface + 0.5f}, 1.5f);
+        }
+
+        [[nodiscard]] Terrain &getTerrain() const {
+            return *_terrain;
+        }
+
+        /// The pad the lander has to touch down on
+        [[nodiscard]] Box &getLandingPad() const {
+            return *_landingPad;
         }
 
         void update(const Float dt) {
-            if(_ground) {
-                _ground.operator*()->update(dt);
+            updateTerrain();
+            syncBoxes(0, _boxes.size(), dt);
+        }
+
+        /// Carve impacts of the last step into the terrain, rebuilds meshes so only on the GL thread
+        void updateTerrain() {
+            if(_terrain) {
+                _terrain->applyImpacts(b2World_GetContactEvents(_worldId));
+                if(_terrain->rebuild()) ++_staticRevision;
+            }
+        }
+
+        /**
+         * Copy body transforms of the boxes in [@p begin, @p end) to their
+         * objects. Disjoint ranges touch disjoint objects and only read the
+         * world, so chunks can run on several threads at once.
+         */
+        void syncBoxes(const std::size_t begin, const std::size_t end, const Float dt) {
+            for(std::size_t i = begin; i != end; ++i) {
+                _boxes[i]->update(dt);
+            }
+        }
+
+        /// Dynamic boxes added with addBox(), in creation order
+        [[nodiscard]] Containers::ArrayView<Box* const> getBoxes() const {
+            return _boxes;
+        }
+
+        [[nodiscard]] MeshCache &getMeshCache() {
+            return _meshes;
+        }
+
+        [[nodiscard]] const InstancedShapes &getInstancedShapes() const {
+            return _instanced;
+        }
+
+        /// Bodies of the rocks in the order they were added
+        [[nodiscard]] Containers::ArrayView<const b2BodyId> getRockBodies() const {
+            return _rockBodies;
+        }
+
+        /// Where the world is in the level, positions authored in level space go through FloatingOrigin::toWorld()
+        [[nodiscard]] FloatingOrigin &getOrigin() {
+            return _origin;
+        }
+
+        [[nodiscard]] const FloatingOrigin &getOrigin() const {
+            return _origin;
+        }
+
+        /**
+         * Move every body of the level and every scene graph object drawing
+         * one by -@p shift, in a single pass over each. Bodies keep their
+         * velocity and sleep state and joints their anchors, so the
+         * simulation goes on as if nothing happened. Call between world
+         * steps, after FloatingOrigin::recenter() returned a shift.
+         * @return Number of bodies moved
+         */
+        std::size_t shiftOrigin(const Vector2 &shift) {
+            Trace::Scope traceScope{"Level::shiftOrigin"};
+
+            for(Box *box: _boxes) {
+                shiftBody(box->getBodyId(), shift);
+                box->getObject().translate(-shift);
             }
 
-            for (const auto &box : _boxes) {
-                box->update(dt);
+            // terrain, pads and static boxes, placed once so they don't follow their bodies
+            for(std::size_t i = 0; i != _groundGroup.size(); ++i) {
+                static_cast<Object2D&>(_groundGroup[i].object()).translate(-shift);
             }
+            std::size_t staticCount = 0;
+            for(const b2BodyId bodyId: _staticBodies) {
+                if(!b2Body_IsValid(bodyId)) continue;
+                shiftBody(bodyId, shift);
+                ++staticCount;
+            }
+            for(const b2BodyId bodyId: _bakedBodies) shiftBody(bodyId, shift);
+            // bakeStaticGeometry() builds the compound bodies from these
+            for(StaticBox &staticBox: _staticBoxes) staticBox.center -= shift;
+            if(_terrain) _terrain->shiftOrigin(shift);
+
+            const std::size_t instancedCount = _instanced.shiftOrigin(shift);
+
+            // cached renders of the static geometry and ray casts against it are stale now
+            ++_staticRevision;
+            return _boxes.size() + staticCount + _bakedBodies.size() + (_terrain ? 1 : 0) + instancedCount;
+        }
+
+        /// Changes whenever the static geometry does, see BackgroundLayer
+        [[nodiscard]] UnsignedLong getStaticRevision() const {
+            return _staticRevision;
         }
 
         void draw(SceneGraph::Camera2D &camera) {
+            drawStatic(camera);
+            drawDynamic(camera);
+        }
+
+        /// Terrain, landing pads and static boxes
+        void drawStatic(SceneGraph::Camera2D &camera) {
             camera.draw(_groundGroup);
+        }
+
+        /// Everything that moves
+        void drawDynamic(SceneGraph::Camera2D &camera) {
             camera.draw(_boxGroup);
+
+            if(_instanced.getCount()) {
+                _instanced.draw(camera.projectionMatrix()*camera.cameraMatrix());
+            }
         }
 
-        void addBox(const DualComplex &transformation) {
+        void addBox(const DualComplex &transformation, const CollisionFilter &filter = CollisionFilter::box()) {
             const auto box = newBox(
                 _boxGroup,
                 transformation,
                 {0.5f, 0.5f},
                 0xffff66_rgbf,
-                1.0f);
+                1.0f,
+                filter);
 
             arrayAppend(_boxes, box);
         };
+
+        /// Small box that collides with the world but not with other debris
+        void addDebris(const DualComplex &transformation) {
+            arrayAppend(_boxes, newBox(_boxGroup, transformation, {0.2f, 0.2f}, 0xb0a890_rgbf, 1.0f,
+                                       CollisionFilter::debris()));
+        }
+
+        /// Dynamic body of any shape, updated and put to sleep like the boxes
+        void addShape(const DualComplex &transformation, const BodyShape &shape, const Color4 &color,
+                      const CollisionFilter &filter = CollisionFilter::box()) {
+            arrayAppend(_boxes, newShape(_boxGroup, transformation, shape, color, b2_dynamicBody,
+                                         BodyDefault::density, filter));
+        }
+
+        /**
+         * Dynamic body without a scene graph object, drawn instanced
+         * together with every other one of the same shape. Meant for large
+         * numbers of rocks and debris.
+         */
+        b2BodyId addRock(const DualComplex &transformation, const BodyShape &shape, const Color3 &color,
+                         const CollisionFilter &filter = CollisionFilter::debris()) {
+            const b2BodyId bodyId = newWorldObjectBody(_worldId, nullptr, transformation, shape,
+                                                       b2_dynamicBody, BodyDefault::density, filter);
+            _instanced.add(bodyId, _meshes.get(shape), color);
+            arrayAppend(_rockBodies, bodyId);
+            return bodyId;
+        }
+
+        /// Static rounded platform with its top at @p top
+        Box *addLandingPad(const Vector2 &top, const Float halfWidth) {
+            constexpr Float halfHeight = 0.15f;
+            constexpr Float radius = 0.1f;
+            ++_staticRevision;
+            return newShape(_groundGroup,
+                            DualComplex::translation(top - Vector2::yAxis(halfHeight + radius)),
+                            BodyShape::roundedBox({halfWidth - radius, halfHeight}, radius),
+                            0xe8c070_rgbf, b2_staticBody, 1.0f, CollisionFilter::staticGeometry());
+        }
+
+        /// Static level geometry, axis-aligned pieces get merged by bakeStaticGeometry()
+        Box *addStaticBox(const DualComplex &transformation, const Vector2 &halfSize,
+                          const Color4 &color = ObjectDefault::color) {
+            const auto box = newBoxStatic(_groundGroup, transformation, halfSize, color);
+            ++_staticRevision;
+            if(Math::abs(Float(transformation.rotation().angle())) < 1.0e-4f) {
+                arrayAppend(_staticBoxes, StaticBox{box, transformation.translation(), halfSize});
+            }
+            return box;
+        }
+
+        std::size_t bakeStaticGeometry();
     };
 
     inline Box *Level::newBox(SceneGraph::DrawableGroup2D &drawable_group, const DualComplex transformation,
-                              const Vector2 size, const Color4 color, const Float density) {
+                              const Vector2 size, const Color4 color, const Float density,
+                              const CollisionFilter &filter) {
         const auto object = new Object2D{&_scene};
         object->setScaling(size);
-        const auto bodyId = newWorldObjectBody(_worldId, object, transformation, size, b2_dynamicBody, density);
+        const auto bodyId = newWorldObjectBody(_worldId, object, transformation, size, b2_dynamicBody, density, filter);
         const auto drawable = new DrawableMesh{*object, _mesh, _shader, color, drawable_group};
 
         return new Box{*object, bodyId, *drawable};
     }
 
     inline Box *Level::newBoxStatic(SceneGraph::DrawableGroup2D &drawable_group, const DualComplex transformation,
-                                    const Vector2 size, const Color4 color) {
+                                    const Vector2 size, const Color4 color, const CollisionFilter &filter) {
         const auto object = new Object2D{&_scene};
-        object->setScaling(size);
-        const auto bodyId = newWorldObjectBody(_worldId, object, transformation, size, b2_staticBody, 1.0f);
+        // static bodies never move, place the object once instead of in update()
+        object->setScaling(size)
+            .setTranslation(transformation.translation())
+            .setRotation(transformation.rotation());
+        const auto bodyId = newWorldObjectBody(_worldId, object, transformation, size, b2_staticBody, 1.0f, filter);
         const auto drawable = new DrawableMesh{*object, _mesh, _shader, color, drawable_group};
+        arrayAppend(_staticBodies, bodyId);
 
         return new Box{*object, bodyId, *drawable};
     }
+
+    inline Box *Level::newShape(SceneGraph::DrawableGroup2D &drawable_group, const DualComplex &transformation,
+                                const BodyShape &shape, const Color4 &color, const b2BodyType type,
+                                const Float density, const CollisionFilter &filter) {
+        // cached meshes are in body units, no scaling
+        const auto object = new Object2D{&_scene};
+        object->setTranslation(transformation.translation())
+            .setRotation(transformation.rotation());
+        const auto bodyId = newWorldObjectBody(_worldId, object, transformation, shape, type, density, filter);
+        const auto drawable = new DrawableMesh{*object, _meshes.get(shape).mesh, _shader, color, drawable_group};
+        if(type == b2_staticBody) arrayAppend(_staticBodies, bodyId);
+
+        return new Box{*object, bodyId, *drawable};
+    }
+
+    /**
+     * Replace the bodies of all axis-aligned static boxes added so far with
+     * a few compound bodies. Boxes sharing a full edge are merged into one
+     * rectangle first, then every group of touching rectangles becomes one
+     * body with a polygon per rectangle. Drawables are kept as they are,
+     * the Box objects' body IDs are invalid afterwards.
+     * @return Number of bodies created
+     */
+    inline std::size_t Level::bakeStaticGeometry() {
+        constexpr Float epsilon = 1.0e-4f;
+        const auto near = [](const Float a, const Float b) { return Math::abs(a - b) < epsilon; };
+
+        Array<Range2D> rectangles;
+        Containers::arrayReserve(rectangles, _staticBoxes.size());
+        for(const StaticBox &staticBox: _staticBoxes) {
+            arrayAppend(rectangles, Range2D::fromCenter(staticBox.center, staticBox.halfSize));
+            b2DestroyBody(staticBox.box->getBodyId());
+        }
+        const std::size_t boxCount = _staticBoxes.size();
+        Containers::arrayClear(_staticBoxes);
+
+        // merge rectangles sharing a full edge until none are left
+        for(bool merged = true; merged; ) {
+            merged = false;
+            for(std::size_t i = 0; i < rectangles.size(); ++i) {
+                for(std::size_t j = i + 1; j < rectangles.size(); ) {
+                    const Range2D &a = rectangles[i];
+                    const Range2D &b = rectangles[j];
+                    const bool row = near(a.bottom(), b.bottom()) && near(a.top(), b.top()) &&
+                        (near(a.right(), b.left()) || near(b.right(), a.left()));
+                    const bool column = near(a.left(), b.left()) && near(a.right(), b.right()) &&
+                        (near(a.top(), b.bottom()) || near(b.top(), a.bottom()));
+                    if(!row && !column) {
+                        ++j;
+                        continue;
+                    }
+
+                    rectangles[i] = Math::join(a, b);
+                    rectangles[j] = rectangles.back();
+                    Containers::arrayRemoveSuffix(rectangles);
+                    merged = true;
+                }
+            }
+        }
+
+        // group touching rectangles, each group becomes one body
+        Array<UnsignedInt> parents{NoInit, rectangles.size()};
+        for(std::size_t i = 0; i != parents.size(); ++i) parents[i] = UnsignedInt(i);
+        const auto find = [&parents](UnsignedInt i) {
+            while(parents[i] != i) i = parents[i] = parents[parents[i]];
+            return i;
+        };
+        for(std::size_t i = 0; i < rectangles.size(); ++i) {
+            for(std::size_t j = i + 1; j < rectangles.size(); ++j) {
+                const Range2D &a = rectangles[i];
+                const Range2D &b = rectangles[j];
+                if(a.left() <= b.right() + epsilon && b.left() <= a.right() + epsilon &&
+                   a.bottom() <= b.top() + epsilon && b.bottom() <= a.top() + epsilon) {
+                    parents[find(UnsignedInt(i))] = find(UnsignedInt(j));
+                }
+            }
+        }
+
+        Array<b2BodyId> groupBodies{ValueInit, rectangles.size()};
+        const std::size_t bodiesBefore = _bakedBodies.size();
+        for(std::size_t i = 0; i != rectangles.size(); ++i) {
+            b2BodyId &bodyId = groupBodies[find(UnsignedInt(i))];
+            if(B2_IS_NULL(bodyId)) {
+                b2BodyDef bodyDefinition = b2DefaultBodyDef();
+                bodyDefinition.type = b2_staticBody;
+                bodyId = b2CreateBody(_worldId, &bodyDefinition);
+                arrayAppend(_bakedBodies, bodyId);
+            }
+
+            const Range2D &rectangle = rectangles[i];
+            const b2Vec2 corners[]{
+                {rectangle.left(), rectangle.bottom()},
+                {rectangle.right(), rectangle.bottom()},
+                {rectangle.right(), rectangle.top()},
+                {rectangle.left(), rectangle.top()}};
+            const b2Hull hull = b2ComputeHull(corners, 4);
+            const b2Polygon polygon = b2MakePolygon(&hull, 0.0f);
+
+            b2ShapeDef shapeDef = b2DefaultShapeDef();
+            CollisionFilter::staticGeometry().apply(shapeDef);
+            const b2ShapeId shapeId = b2CreatePolygonShape(bodyId, &shapeDef, &polygon);
+            b2Shape_SetFriction(shapeId, BodyDefault::friction);
+        }
+
+        const std::size_t bodyCount = _bakedBodies.size() - bodiesBefore;
+        ++_staticRevision;
+        Debug{} << "[level] baked" << boxCount << "static boxes into" << rectangles.size()
+            << "shapes on" << bodyCount << "bodies";
+        return bodyCount;
+    }
 }
 
 #endif //MAGNUM_MOONLANDER_LEVEL_H
\ No newline at end of file
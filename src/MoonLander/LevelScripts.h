@@ -0,0 +1,67 @@
+#ifndef MAGNUM_MOONLANDER_LEVELSCRIPTS_H
+#define MAGNUM_MOONLANDER_LEVELSCRIPTS_H
+
+#include <box2d/box2d.h>
+
+#include "Lander.h"
+#include "Level.h"
+#include "Script.h"
+
+namespace Magnum::Game {
+    /**
+     * Award points once the lander rests on the pad, more for fuel left.
+     * A bounce or a landing still moving doesn't count, the script then
+     * waits for the next touchdown. Neither does a crash onto the pad,
+     * which disables the body. After scoring it waits for @p reset, so
+     * every new lander can score once.
+     */
+    inline Script landedThenScore(Signal &touchdown, Signal &reset, const b2BodyId landerBodyId,
+                                  const Lander &lander, UnsignedInt &score) {
+        constexpr Float restingSpeed = 0.1f;
+
+        for(;;) {
+            co_await waitFor(touchdown);
+
+            // let it settle
+            co_await sleep(1.0);
+            if(!b2Body_IsEnabled(landerBodyId)) continue;
+            if(b2Length(b2Body_GetLinearVelocity(landerBodyId)) < restingSpeed) {
+                score += 100 + UnsignedInt(lander.getFuel()*10.0f);
+                co_await waitFor(reset);
+            }
+        }
+    }
+
+    /**
+     * Award points once the cargo capsule rests on the pad, whether it's
+     * still on the rope or was let go of right above it.
+     */
+    inline Script cargoDelivered(Signal &touchdown, const b2BodyId capsuleBodyId, UnsignedInt &score) {
+        constexpr Float restingSpeed = 0.1f;
+
+        for(;;) {
+            co_await waitFor(touchdown);
+
+            co_await sleep(1.0);
+            if(b2Length(b2Body_GetLinearVelocity(capsuleBodyId)) < restingSpeed) {
+                score += 250;
+                co_return;
+            }
+        }
+    }
+
+    /// Drop @p waves waves of boxes over the terrain, one box per tick
+    inline Script boxWaves(Level &level, const Int waves, const Int boxesPerWave, const Double interval) {
+        for(Int wave = 0; wave != waves; ++wave) {
+            for(Int i = 0; i != boxesPerWave; ++i) {
+                const Float x = -12.0f + 24.0f*Float(i)/Float(Math::max(boxesPerWave - 1, 1));
+                level.addBox(DualComplex::translation(level.getOrigin().toWorld({x, 12.0f + Float(wave % 2)})));
+                co_await nextTick();
+            }
+
+            co_await sleep(interval);
+        }
+    }
+}
+
+#endif //MAGNUM_MOONLANDER_LEVELSCRIPTS_H
@@ -0,0 +1,92 @@
+#ifndef MAGNUM_MOONLANDER_MESHCACHE_H
+#define MAGNUM_MOONLANDER_MESHCACHE_H
+
+#include <unordered_map>
+
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Utility/Debug.h>
+
+#include <Magnum/GL/Buffer.h>
+#include <Magnum/GL/Mesh.h>
+#include <Magnum/Shaders/Flat.h>
+
+#include "BodyShape.h"
+
+namespace Magnum::Game {
+    /**
+     * GPU meshes of body shapes, generated on first use and shared by
+     * every body with the same shape parameters. Meshes are triangle fans
+     * of the shape outline in body-local units, so objects drawing them
+     * keep a unit scale.
+     */
+    class MeshCache {
+    public:
+        struct Entry {
+            GL::Buffer vertices;
+            GL::Mesh mesh;
+            UnsignedInt vertexCount;
+        };
+
+        /// Mesh for @p shape, the reference stays valid for the cache lifetime
+        Entry &get(const BodyShape &shape) {
+            const auto found = _entries.find(shape);
+            if(found != _entries.end()) {
+                ++_hitCount;
+                return found->second;
+            }
+
+            ++_missCount;
+            Containers::arrayClear(_outline);
+            shape.outline(_outline);
+
+            Entry &entry = _entries.try_emplace(shape).first->second;
+            entry.vertexCount = UnsignedInt(_outline.size());
+            entry.vertices.setData(_outline, GL::BufferUsage::StaticDraw);
+            entry.mesh.setPrimitive(GL::MeshPrimitive::TriangleFan)
+                .setCount(Int(entry.vertexCount))
+                .addVertexBuffer(entry.vertices, 0, Shaders::FlatGL2D::Position{});
+
+            _bytes += _outline.size()*sizeof(Vector2);
+            return entry;
+        }
+
+        [[nodiscard]] std::size_t getMeshCount() const {
+            return _entries.size();
+        }
+
+        [[nodiscard]] UnsignedLong getHitCount() const {
+            return _hitCount;
+        }
+
+        [[nodiscard]] UnsignedLong getMissCount() const {
+            return _missCount;
+        }
+
+        /// Share of get() calls that found an existing mesh
+        [[nodiscard]] Double getHitRate() const {
+            const UnsignedLong total = _hitCount + _missCount;
+            return total ? Double(_hitCount)/Double(total) : 0.0;
+        }
+
+        /// Vertex data uploaded to the GPU
+        [[nodiscard]] std::size_t getGpuBytes() const {
+            return _bytes;
+        }
+
+        void print() const {
+            Debug{} << "[meshes]" << _entries.size() << "meshes," << _bytes << "bytes on the GPU, hit rate"
+                << getHitRate()*100.0 << Debug::nospace << "% of" << _hitCount + _missCount << "requests";
+        }
+
+    private:
+        std::unordered_map<BodyShape, Entry, BodyShape::Hash> _entries;
+        // scratch for outline generation, reused between misses
+        Containers::Array<Vector2> _outline;
+
+        UnsignedLong _hitCount = 0;
+        UnsignedLong _missCount = 0;
+        std::size_t _bytes = 0;
+    };
+}
+
+#endif //MAGNUM_MOONLANDER_MESHCACHE_H
@@ -0,0 +1,212 @@
+#ifndef MAGNUM_MOONLANDER_PHYSICSLOD_H
+#define MAGNUM_MOONLANDER_PHYSICSLOD_H
+
+#include <unordered_map>
+
+#include <Corrade/Containers/GrowableArray.h>
+#include <Magnum/Math/Range.h>
+
+#include <box2d/box2d.h>
+
+#include "Box.h"
+#include "Trace.h"
+
+namespace Magnum::Game {
+    /**
+     * Physics level of detail for dynamic boxes and rocks far from the
+     * camera.
+     *
+     * Bodies beyond the view rectangle plus sleepMargin are settling: they
+     * get a higher sleep threshold, so Box2D puts them to sleep as soon as
+     * their island comes to rest. They're never forced asleep, that would
+     * take the whole island down with them, including bodies still near
+     * the view. Settled bodies that are asleep on their own beyond
+     * freezeMargin become kinematic "frozen" proxies with zero velocity
+     * that the solver doesn't integrate. A body comes back when it gets
+     * near the view again or when something touches it. Leaving a state
+     * needs hysteresis extra distance and a minimum dwell time, so bodies
+     * on a boundary don't thrash.
+     *
+     * Only updateBudget bodies are checked per update, round-robin, so
+     * large levels pay a bounded cost per tick.
+     */
+    class PhysicsLod {
+    public:
+        enum class State: UnsignedByte {
+            Active,
+            Settling,
+            Frozen
+        };
+
+        struct Configuration {
+            Float sleepMargin = 10.0f;
+            Float freezeMargin = 30.0f;
+            Float hysteresis = 4.0f;
+            /// Sleep threshold of settling bodies in m/s, Box2D's default is 0.05
+            Float settlingSleepThreshold = 0.5f;
+            /// Ticks a body stays in a state before distance can change it again
+            UnsignedInt minTicksInState = 30;
+            /// Bodies checked per update
+            UnsignedInt updateBudget = 512;
+        };
+
+        PhysicsLod(): PhysicsLod{Configuration{}} {}
+
+        explicit PhysicsLod(const Configuration &configuration): _configuration(configuration) {}
+
+        [[nodiscard]] const Configuration &configuration() const {
+            return _configuration;
+        }
+
+        [[nodiscard]] UnsignedInt count(const State state) const {
+            return _counts[UnsignedByte(state)];
+        }
+
+        /**
+         * Call after the world step, contact begin events are consumed to
+         * wake frozen bodies that got touched.
+         * @param worldId World the bodies live in
+         * @param view World-space view rectangle, see CameraControl::viewRectangle()
+         * @param boxes All dynamic boxes, new ones may only be appended
+         * @param rocks All instanced rocks, see Level::getRockBodies(), new ones may only be appended
+         */
+        void update(const b2WorldId worldId, const Range2D &view, const Containers::ArrayView<Box* const> boxes,
+                    const Containers::ArrayView<const b2BodyId> rocks) {
+            Trace::Scope traceScope{"PhysicsLod::update"};
+
+            // pick up bodies added since the last update
+            for(; _boxCount < boxes.size(); ++_boxCount) add(boxes[_boxCount]->getBodyId());
+            for(; _rockCount < rocks.size(); ++_rockCount) add(rocks[_rockCount]);
+
+            ++_tick;
+
+            // anything touching a frozen proxy wakes it up right away
+            const b2ContactEvents contactEvents = b2World_GetContactEvents(worldId);
+            for(Int i = 0; i != contactEvents.beginCount; ++i) {
+                wakeIfFrozen(b2Shape_GetBody(contactEvents.beginEvents[i].shapeIdA));
+                wakeIfFrozen(b2Shape_GetBody(contactEvents.beginEvents[i].shapeIdB));
+            }
+
+            const std::size_t checks = Math::min(std::size_t(_configuration.updateBudget), _entries.size());
+            for(std::size_t i = 0; i != checks; ++i) {
+                if(_cursor >= _entries.size()) _cursor = 0;
+                updateEntry(_entries[_cursor++], view);
+            }
+
+            Trace::counter("lod active", count(State::Active));
+            Trace::counter("lod settling", count(State::Settling));
+            Trace::counter("lod frozen", count(State::Frozen));
+        }
+
+    private:
+        struct Entry {
+            b2BodyId bodyId;
+            State state = State::Active;
+            UnsignedInt changedTick = 0;
+            b2Vec2 linearVelocity{};
+            Float angularVelocity = 0.0f;
+            /// Restored once the body is active again
+            Float sleepThreshold = 0.0f;
+        };
+
+        void add(const b2BodyId bodyId) {
+            _indices.emplace(bodyId.index1, UnsignedInt(_entries.size()));
+            Containers::arrayAppend(_entries, Entry{bodyId});
+            _entries.back().sleepThreshold = b2Body_GetSleepThreshold(bodyId);
+            ++_counts[UnsignedByte(State::Active)];
+        }
+
+        static Float distanceOutside(const Range2D &view, const Vector2 &point) {
+            return Math::max(Math::max(view.min() - point, point - view.max()), Vector2{0.0f}).length();
+        }
+
+        void setState(Entry &entry, const State state) {
+            --_counts[UnsignedByte(entry.state)];
+            ++_counts[UnsignedByte(state)];
+            entry.state = state;
+            entry.changedTick = _tick;
+        }
+
+        void freeze(Entry &entry) {
+            entry.linearVelocity = b2Body_GetLinearVelocity(entry.bodyId);
+            entry.angularVelocity = b2Body_GetAngularVelocity(entry.bodyId);
+            b2Body_SetType(entry.bodyId, b2_kinematicBody);
+            b2Body_SetLinearVelocity(entry.bodyId, b2Vec2_zero);
+            b2Body_SetAngularVelocity(entry.bodyId, 0.0f);
+            setState(entry, State::Frozen);
+        }
+
+        void activate(Entry &entry) {
+            b2Body_SetSleepThreshold(entry.bodyId, entry.sleepThreshold);
+            b2Body_SetAwake(entry.bodyId, true);
+            setState(entry, State::Active);
+        }
+
+        void thaw(Entry &entry, const State state) {
+            b2Body_SetType(entry.bodyId, b2_dynamicBody);
+            b2Body_SetLinearVelocity(entry.bodyId, entry.linearVelocity);
+            b2Body_SetAngularVelocity(entry.bodyId, entry.angularVelocity);
+            if(state == State::Active) activate(entry);
+            else setState(entry, state);
+        }
+
+        void wakeIfFrozen(const b2BodyId bodyId) {
+            const auto found = _indices.find(bodyId.index1);
+            if(found == _indices.end()) return;
+
+            Entry &entry = _entries[found->second];
+            if(entry.state == State::Frozen && B2_ID_EQUALS(entry.bodyId, bodyId)) {
+                thaw(entry, State::Active);
+            }
+        }
+
+        void updateEntry(Entry &entry, const Range2D &view) {
+            if(!b2Body_IsValid(entry.bodyId)) return;
+
+            const b2Vec2 position = b2Body_GetPosition(entry.bodyId);
+            const Float distance = distanceOutside(view, {position.x, position.y});
+            const bool settled = _tick - entry.changedTick >= _configuration.minTicksInState;
+
+            switch(entry.state) {
+                case State::Active:
+                    if(settled && distance > _configuration.sleepMargin + _configuration.hysteresis) {
+                        b2Body_SetSleepThreshold(entry.bodyId, _configuration.settlingSleepThreshold);
+                        setState(entry, State::Settling);
+                    }
+                    break;
+
+                case State::Settling:
+                    // only bodies whose island went to sleep by itself are frozen
+                    if(distance <= _configuration.sleepMargin) {
+                        activate(entry);
+                    } else if(settled && distance > _configuration.freezeMargin + _configuration.hysteresis &&
+                              !b2Body_IsAwake(entry.bodyId)) {
+                        freeze(entry);
+                    }
+                    break;
+
+                case State::Frozen:
+                    if(distance <= _configuration.sleepMargin) {
+                        thaw(entry, State::Active);
+                    } else if(settled && distance <= _configuration.freezeMargin) {
+                        thaw(entry, State::Settling);
+                    }
+                    break;
+            }
+        }
+
+        Configuration _configuration;
+
+        Containers::Array<Entry> _entries;
+        // body index -> entry, for mapping contact events
+        std::unordered_map<Int, UnsignedInt> _indices;
+        UnsignedInt _counts[3]{};
+
+        std::size_t _boxCount = 0;
+        std::size_t _rockCount = 0;
+        std::size_t _cursor = 0;
+        UnsignedInt _tick = 0;
+    };
+}
+
+#endif //MAGNUM_MOONLANDER_PHYSICSLOD_H
@@ -0,0 +1,202 @@
+#ifndef MAGNUM_MOONLANDER_PHYSICSSTEPSCHEDULER_H
+#define MAGNUM_MOONLANDER_PHYSICSSTEPSCHEDULER_H
+
+#include <chrono>
+
+#include <Corrade/Utility/Debug.h>
+
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Functions.h>
+
+#include <box2d/box2d.h>
+
+#include "Trace.h"
+
+namespace Magnum::Game {
+    /**
+     * Picks the Box2D substep count for every world step. Quality follows
+     * the scene: more substeps while the lander touches down at speed,
+     * fewer while the scene is idle. The measured cost per substep caps the
+     * count so the step stays within a CPU budget on slow machines.
+     *
+     * Every decision is recorded as trace counters (see Trace::counter()).
+     */
+    class PhysicsStepScheduler {
+    public:
+        enum class Reason: UnsignedByte {
+            Fixed,
+            Idle,
+            Default,
+            Touchdown,
+            Budget
+        };
+
+        struct Configuration {
+            /// CPU time a world step may take, zero keeps the substep count fixed at defaultSubSteps
+            Double budgetMilliseconds = 2.0;
+            Int minSubSteps = 2;
+            Int defaultSubSteps = 6;
+            Int maxSubSteps = 8;
+            /// Lander in contact and faster than this is a touchdown
+            Float touchdownSpeed = 0.5f;
+            /// Lander slower than this with no contacts changing is idle
+            Float idleSpeed = 0.05f;
+            /// Weight of the newest sample in the cost average
+            Double smoothing = 0.1;
+            /// Print every change of the substep count
+            bool verbose = false;
+        };
+
+        PhysicsStepScheduler(): PhysicsStepScheduler{Configuration{}} {}
+
+        /**
+         * The substep counts come from the command line, so the bounds are
+         * made consistent and the default is clamped into them.
+         */
+        explicit PhysicsStepScheduler(const Configuration &configuration): _configuration(configuration) {
+            _configuration.minSubSteps = Math::max(_configuration.minSubSteps, 1);
+            _configuration.maxSubSteps = Math::max(_configuration.maxSubSteps, _configuration.minSubSteps);
+            _configuration.defaultSubSteps = Math::clamp(_configuration.defaultSubSteps,
+                _configuration.minSubSteps, _configuration.maxSubSteps);
+            _subSteps = _configuration.defaultSubSteps;
+        }
+
+        /**
+         * Contacts of @p bodyId that actually touch, for update(). The
+         * contact capacity of a body also counts contacts whose shapes only
+         * overlap in the broadphase. Doesn't allocate, a body with more
+         * than 64 contacts counts as having 64.
+         */
+        static Int touchingContactCount(const b2BodyId bodyId) {
+            constexpr Int MaxContacts = 64;
+            b2ContactData contacts[MaxContacts];
+            const Int count = b2Body_GetContactData(bodyId, contacts,
+                Math::min(b2Body_GetContactCapacity(bodyId), MaxContacts));
+
+            Int touching = 0;
+            for(Int i = 0; i != count; ++i) {
+                if(contacts[i].manifold.pointCount > 0) ++touching;
+            }
+            return touching;
+        }
+
+        [[nodiscard]] const Configuration &configuration() const {
+            return _configuration;
+        }
+
+        [[nodiscard]] Int subSteps() const {
+            return _subSteps;
+        }
+
+        [[nodiscard]] Reason reason() const {
+            return _reason;
+        }
+
+        /// CPU time of the last step
+        [[nodiscard]] Double stepMilliseconds() const {
+            return _stepMilliseconds;
+        }
+
+        /// Smoothed CPU time of a single substep
+        [[nodiscard]] Double subStepMilliseconds() const {
+            return _subStepMilliseconds;
+        }
+
+        /// Step the world with the current substep count and measure it
+        void step(const b2WorldId worldId, const Float dt) {
+            Trace::Scope traceScope{"b2World_Step"};
+
+            const auto begin = std::chrono::steady_clock::now();
+            b2World_Step(worldId, dt, _subSteps);
+            _stepMilliseconds = std::chrono::duration<Double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+            const Double sample = _stepMilliseconds/Double(_subSteps);
+            _subStepMilliseconds = _subStepMilliseconds == 0.0 ? sample :
+                Math::lerp(_subStepMilliseconds, sample, _configuration.smoothing);
+        }
+
+        /**
+         * Decide the substep count for the next step.
+         * @param worldContactCount Contacts in the world, from b2World_GetCounters()
+         * @param landerContactCount Touching contacts of the lander body, see touchingContactCount()
+         * @param landerSpeed Linear speed of the lander
+         */
+        void update(const Int worldContactCount, const Int landerContactCount, const Float landerSpeed) {
+            const Int previous = _subSteps;
+
+            if(_configuration.budgetMilliseconds <= 0.0) {
+                _subSteps = _configuration.defaultSubSteps;
+                _reason = Reason::Fixed;
+            } else {
+                Int target = _configuration.defaultSubSteps;
+                _reason = Reason::Default;
+
+                if(landerContactCount > 0 && landerSpeed >= _configuration.touchdownSpeed) {
+                    target = _configuration.maxSubSteps;
+                    _reason = Reason::Touchdown;
+                } else if(landerSpeed < _configuration.idleSpeed && worldContactCount == _previousContactCount) {
+                    target = _configuration.minSubSteps;
+                    _reason = Reason::Idle;
+                }
+
+                // never plan more substeps than the budget affords at the measured cost
+                if(_subStepMilliseconds > 0.0) {
+                    const Int affordable = Int(_configuration.budgetMilliseconds/_subStepMilliseconds);
+                    if(affordable < target) {
+                        target = affordable;
+                        _reason = Reason::Budget;
+                    }
+                }
+
+                target = Math::clamp(target, _configuration.minSubSteps, _configuration.maxSubSteps);
+
+                // jump up for touchdown or an over-budget step, otherwise move one substep
+                // per tick so the count doesn't oscillate with timing noise
+                if(_reason == Reason::Touchdown || _reason == Reason::Budget) {
+                    _subSteps = target;
+                } else if(target > _subSteps) {
+                    ++_subSteps;
+                } else if(target < _subSteps) {
+                    --_subSteps;
+                }
+            }
+
+            _previousContactCount = worldContactCount;
+
+            Trace::counter("physics substeps", _subSteps);
+            Trace::counter("physics step ms", _stepMilliseconds);
+            Trace::counter("physics substep reason", Double(UnsignedByte(_reason)));
+
+            if(_configuration.verbose && _subSteps != previous) {
+                Debug{} << "[physics] substeps" << previous << "->" << _subSteps
+                    << "(" << Debug::nospace << reasonName(_reason) << Debug::nospace << ", step"
+                    << _stepMilliseconds << "ms, contacts" << worldContactCount
+                    << Debug::nospace << ", lander speed" << landerSpeed << Debug::nospace << ")";
+            }
+        }
+
+        static const char *reasonName(const Reason reason) {
+            switch(reason) {
+                case Reason::Fixed: return "fixed";
+                case Reason::Idle: return "idle";
+                case Reason::Default: return "default";
+                case Reason::Touchdown: return "touchdown";
+                case Reason::Budget: return "budget";
+            }
+
+            return "unknown";
+        }
+
+    private:
+        Configuration _configuration;
+
+        Int _subSteps;
+        Reason _reason = Reason::Default;
+        Int _previousContactCount = 0;
+
+        Double _stepMilliseconds = 0.0;
+        Double _subStepMilliseconds = 0.0;
+    };
+}
+
+#endif //MAGNUM_MOONLANDER_PHYSICSSTEPSCHEDULER_H
@@ -0,0 +1,172 @@
+#ifndef MAGNUM_MOONLANDER_RANGESCANNER_H
+#define MAGNUM_MOONLANDER_RANGESCANNER_H
+
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/ArrayView.h>
+#include <Corrade/Utility/Debug.h>
+
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Angle.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Vector2.h>
+
+#include <box2d/box2d.h>
+
+#include "Collision.h"
+#include "Trace.h"
+
+namespace Magnum::Game {
+    /**
+     * Radar altimeter and a fan of ground scanning rays attached to a body.
+     *
+     * A scan casts one closest-hit ray straight down for the altitude and
+     * rayCount rays spread over fanAngle around the body's down axis. The
+     * results live in arrays allocated once. If neither the body pose nor
+     * the static revision changed meaningfully since the last scan, the
+     * previous results are kept and nothing is cast, which is exact for the
+     * default static-only mask and approximate if dynamic categories are
+     * scanned as well.
+     */
+    class RangeScanner {
+    public:
+        struct Configuration {
+            UnsignedInt rayCount = 256;
+            Deg fanAngle{120.0f};
+            /// Ray length in world units, also the altitude if nothing is hit
+            Float range = 40.0f;
+            /// Categories the rays hit
+            UnsignedLong mask = CollisionCategory::Terrain|CollisionCategory::Static;
+            /// Pose change below which the last results are reused
+            Float positionTolerance = 0.01f;
+            Deg angleTolerance{0.25f};
+        };
+
+        struct Ray {
+            Vector2 point;
+            Vector2 normal;
+            /// Distance from the body, range if nothing was hit
+            Float distance;
+            bool hit;
+        };
+
+        RangeScanner(): RangeScanner{Configuration{}} {}
+
+        explicit RangeScanner(const Configuration &configuration):
+            _configuration(configuration),
+            _filter(CollisionFilter::query(configuration.mask)),
+            _directions{NoInit, configuration.rayCount},
+            _rays{ValueInit, configuration.rayCount},
+            _cosAngleTolerance(Math::cos(Rad{configuration.angleTolerance}))
+        {
+            // body-local directions, fanned symmetrically around -Y
+            const Rad fan{configuration.fanAngle};
+            for(UnsignedInt i = 0; i != configuration.rayCount; ++i) {
+                const Float t = configuration.rayCount > 1 ? Float(i)/Float(configuration.rayCount - 1) - 0.5f : 0.0f;
+                const Rad angle = fan*t - Rad{Constants::piHalf()};
+                _directions[i] = {Math::cos(angle), Math::sin(angle)};
+            }
+        }
+
+        [[nodiscard]] const Configuration &configuration() const {
+            return _configuration;
+        }
+
+        /**
+         * Scan from the pose of @p bodyId.
+         * @param staticRevision Changes whenever static geometry does
+         * @return Whether rays were cast, false if the last results were reused
+         */
+        bool scan(const b2WorldId worldId, const b2BodyId bodyId, const UnsignedLong staticRevision = 0) {
+            const b2Vec2 position = b2Body_GetPosition(bodyId);
+            const b2Rot rotation = b2Body_GetRotation(bodyId);
+
+            if(_valid && staticRevision == _revision
+                && b2DistanceSquared(position, _position) < _configuration.positionTolerance*_configuration.positionTolerance
+                && rotation.c*_rotation.c + rotation.s*_rotation.s >= _cosAngleTolerance) {
+                ++_reuseCount;
+                return false;
+            }
+
+            Trace::Scope traceScope{"RangeScanner::scan"};
+
+            _altitude = cast(worldId, position, {0.0f, -1.0f});
+            for(UnsignedInt i = 0; i != _directions.size(); ++i) {
+                const b2Vec2 direction = b2RotateVector(rotation, {_directions[i].x(), _directions[i].y()});
+                _rays[i] = cast(worldId, position, direction);
+            }
+
+            _position = position;
+            _rotation = rotation;
+            _revision = staticRevision;
+            _valid = true;
+            ++_scanCount;
+            return true;
+        }
+
+        /// Cast again on the next scan() even if nothing moved
+        void invalidate() {
+            _valid = false;
+        }
+
+        /// Straight down, independent of the body rotation
+        [[nodiscard]] const Ray &getAltitude() const {
+            return _altitude;
+        }
+
+        /// Fan rays from left to right in body space
+        [[nodiscard]] Containers::ArrayView<const Ray> getRays() const {
+            return _rays;
+        }
+
+        /// Shortest distance in the fan, the clearance an autopilot cares about
+        [[nodiscard]] Float getClosestDistance() const {
+            Float closest = _configuration.range;
+            for(const Ray &ray: _rays) closest = Math::min(closest, ray.distance);
+            return closest;
+        }
+
+        [[nodiscard]] UnsignedLong getScanCount() const {
+            return _scanCount;
+        }
+
+        [[nodiscard]] UnsignedLong getReuseCount() const {
+            return _reuseCount;
+        }
+
+        void print() const {
+            Debug{} << "[scanner]" << _rays.size() + 1 << "rays," << _scanCount << "scans cast,"
+                << _reuseCount << "reused";
+        }
+
+    private:
+        Ray cast(const b2WorldId worldId, const b2Vec2 origin, const b2Vec2 direction) const {
+            const b2RayResult result = b2World_CastRayClosest(worldId, origin,
+                b2MulSV(_configuration.range, direction), _filter);
+            if(!result.hit) {
+                return {{origin.x + direction.x*_configuration.range, origin.y + direction.y*_configuration.range},
+                        {}, _configuration.range, false};
+            }
+
+            return {{result.point.x, result.point.y}, {result.normal.x, result.normal.y},
+                    result.fraction*_configuration.range, true};
+        }
+
+        Configuration _configuration;
+        b2QueryFilter _filter;
+
+        Containers::Array<Vector2> _directions;
+        Containers::Array<Ray> _rays;
+        Ray _altitude{};
+
+        Float _cosAngleTolerance;
+        b2Vec2 _position{};
+        b2Rot _rotation{1.0f, 0.0f};
+        UnsignedLong _revision = 0;
+        bool _valid = false;
+
+        UnsignedLong _scanCount = 0;
+        UnsignedLong _reuseCount = 0;
+    };
+}
+
+#endif //MAGNUM_MOONLANDER_RANGESCANNER_H
@@ -0,0 +1,90 @@
+#ifndef MAGNUM_MOONLANDER_REDRAWTRACKER_H
+#define MAGNUM_MOONLANDER_REDRAWTRACKER_H
+
+#include <Corrade/Utility/Debug.h>
+
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Matrix3.h>
+#include <Magnum/SceneGraph/Camera.h>
+
+#include <box2d/box2d.h>
+
+#include "Trace.h"
+
+namespace Magnum::Game {
+    /**
+     * Collects reasons to draw a new frame for on-demand rendering. Every
+     * tick the sources are checked; a frame is drawn only if any of them
+     * reported damage since the last one, otherwise the previous frame is
+     * still on screen and correct.
+     */
+    class RedrawTracker {
+    public:
+        enum class Reason: UnsignedByte {
+            Bodies = 1 << 0,
+            Animation = 1 << 1,
+            Camera = 1 << 2,
+            Input = 1 << 3,
+            Layer = 1 << 4,
+            Resize = 1 << 5
+        };
+
+        void damage(const Reason reason) {
+            _pending |= UnsignedByte(reason);
+        }
+
+        /// Damage if any awake body moved in the last step, from Box2D body events
+        void checkBodies(const b2WorldId worldId) {
+            if(b2World_GetBodyEvents(worldId).moveCount > 0) damage(Reason::Bodies);
+        }
+
+        void checkAnimations(const std::size_t changedFrames) {
+            if(changedFrames) damage(Reason::Animation);
+        }
+
+        void checkCamera(SceneGraph::Camera2D &camera) {
+            const Matrix3 matrix = camera.projectionMatrix()*camera.cameraMatrix();
+            if(matrix != _cameraMatrix) {
+                _cameraMatrix = matrix;
+                damage(Reason::Camera);
+            }
+        }
+
+        /// Whether to draw a frame, resets the damage
+        bool consume() {
+            const UnsignedByte pending = _pending;
+            _pending = 0;
+
+            Trace::counter("redraw reasons", pending);
+            if(!pending) {
+                ++_skippedFrames;
+                return false;
+            }
+
+            ++_drawnFrames;
+            return true;
+        }
+
+        [[nodiscard]] UnsignedLong getDrawnFrames() const {
+            return _drawnFrames;
+        }
+
+        [[nodiscard]] UnsignedLong getSkippedFrames() const {
+            return _skippedFrames;
+        }
+
+        void print() const {
+            Debug{} << "[redraw]" << _drawnFrames << "frames drawn," << _skippedFrames << "skipped";
+        }
+
+    private:
+        // the first frame always draws
+        UnsignedByte _pending = UnsignedByte(Reason::Resize);
+        Matrix3 _cameraMatrix{Math::ZeroInit};
+
+        UnsignedLong _drawnFrames = 0;
+        UnsignedLong _skippedFrames = 0;
+    };
+}
+
+#endif //MAGNUM_MOONLANDER_REDRAWTRACKER_H
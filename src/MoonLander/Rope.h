@@ -0,0 +1,250 @@
+#ifndef MAGNUM_MOONLANDER_ROPE_H
+#define MAGNUM_MOONLANDER_ROPE_H
+
+#include <Corrade/Containers/GrowableArray.h>
+
+#include <Magnum/GL/Buffer.h>
+#include <Magnum/GL/Mesh.h>
+#include <Magnum/Math/Color.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Matrix3.h>
+
+#include <box2d/box2d.h>
+
+#include "Collision.h"
+#include "FloatingOrigin.h"
+#include "ShaderCache.h"
+#include "Trace.h"
+
+namespace Magnum::Game {
+    using namespace Math::Literals;
+
+    /**
+     * Rope between two bodies, a chain of capsule segments linked by
+     * revolute joints. A long chain under a heavy load stretches and
+     * jitters with a handful of substeps, so a distance joint between the
+     * two bodies carries the load instead: it lets them come closer
+     * freely but never further apart than the rope is long, and the
+     * segments only have to follow. The rope's own mass is fixed, so it
+     * behaves the same no matter how finely it's cut.
+     *
+     * The whole rope is drawn as one triangle strip streamed every frame.
+     */
+    class Rope {
+    public:
+        struct Configuration {
+            /// At least 2
+            UnsignedInt segmentCount = 100;
+            /// Rest length from anchor to anchor, segments are length/segmentCount long
+            Float length = 10.0f;
+            Float radius = 0.05f;
+            /// Mass of the whole rope, split over the segments
+            Float mass = 0.5f;
+            Float linearDamping = 0.05f;
+            /// Keeps the segments from whipping around
+            Float angularDamping = 2.0f;
+            Color4 color = 0x8a7f70_rgbf;
+            CollisionFilter filter = CollisionFilter::rope();
+        };
+
+        /**
+         * Hang a rope from @p localAnchorA on @p bodyA to @p localAnchorB
+         * on @p bodyB. If the anchors are closer than the rope is long, it
+         * starts folded in a zig-zag between them; if they're further
+         * apart, the distance joint pulls them together.
+         */
+        explicit Rope(ShaderCache &shaders, const b2WorldId worldId, const b2BodyId bodyA, const Vector2 &localAnchorA,
+                      const b2BodyId bodyB, const Vector2 &localAnchorB, const Configuration &configuration):
+            _shader(shaders.flat({})), _worldId(worldId), _configuration(configuration)
+        {
+            Trace::Scope traceScope{"Rope::Rope"};
+
+            const UnsignedInt count = Math::max(configuration.segmentCount, 2u);
+            _halfLength = configuration.length/Float(count)*0.5f;
+
+            const b2Vec2 anchorA{localAnchorA.x(), localAnchorA.y()};
+            const b2Vec2 anchorB{localAnchorB.x(), localAnchorB.y()};
+            const b2Vec2 start = b2Body_GetWorldPoint(bodyA, anchorA);
+            const b2Vec2 end = b2Body_GetWorldPoint(bodyB, anchorB);
+
+            /* Fold the segments so the rope spans the anchors exactly. An
+               odd count leaves the middle segment straight. */
+            const Float segmentLength = _halfLength*2.0f;
+            const Float distance = b2Distance(start, end);
+            const b2Vec2 along = distance > segmentLength*0.01f ? b2MulSV(1.0f/distance, b2Sub(end, start)) : b2Vec2{0.0f, -1.0f};
+            const b2Vec2 across = b2LeftPerp(along);
+            const bool odd = count % 2;
+            const Float cosFold = Math::clamp(odd ? (distance - segmentLength)/(Float(count - 1)*segmentLength)
+                                                  : distance/(Float(count)*segmentLength), 0.0f, 1.0f);
+            const Float sinFold = Math::sqrt(1.0f - cosFold*cosFold);
+
+            b2BodyDef bodyDefinition = b2DefaultBodyDef();
+            bodyDefinition.type = b2_dynamicBody;
+            bodyDefinition.linearDamping = configuration.linearDamping;
+            bodyDefinition.angularDamping = configuration.angularDamping;
+
+            const b2Capsule capsule = b2MakeCapsule({-_halfLength, 0.0f}, {_halfLength, 0.0f}, configuration.radius);
+            b2ShapeDef shapeDefinition = b2DefaultShapeDef();
+            configuration.filter.apply(shapeDefinition);
+            shapeDefinition.density = configuration.mass/(Float(count)*b2ComputeCapsuleMass(&capsule, 1.0f).mass);
+            // hundreds of segments touching the ground would flood the event arrays
+            shapeDefinition.enableContactEvents = false;
+
+            Containers::arrayReserve(_segments, count);
+            b2Vec2 position = start;
+            for(UnsignedInt i = 0, folded = 0; i != count; ++i) {
+                b2Vec2 direction = along;
+                if(!odd || i != count/2) {
+                    const Float side = folded++ % 2 ? -sinFold : sinFold;
+                    direction = b2Add(b2MulSV(cosFold, along), b2MulSV(side, across));
+                }
+
+                bodyDefinition.position = b2MulAdd(position, _halfLength, direction);
+                bodyDefinition.rotation = b2Rot{direction.x, direction.y};
+                const b2BodyId segmentId = b2CreateBody(worldId, &bodyDefinition);
+                b2CreateCapsuleShape(segmentId, &shapeDefinition, &capsule);
+                Containers::arrayAppend(_segments, segmentId);
+
+                position = b2MulAdd(position, segmentLength, direction);
+            }
+
+            b2RevoluteJointDef link = b2DefaultRevoluteJointDef();
+            connect(link, bodyA, anchorA, _segments[0], {-_halfLength, 0.0f});
+            b2CreateRevoluteJoint(worldId, &link);
+            for(UnsignedInt i = 0; i + 1 != count; ++i) {
+                connect(link, _segments[i], {_halfLength, 0.0f}, _segments[i + 1], {-_halfLength, 0.0f});
+                b2CreateRevoluteJoint(worldId, &link);
+            }
+            connect(link, _segments[count - 1], {_halfLength, 0.0f}, bodyB, anchorB);
+            b2CreateRevoluteJoint(worldId, &link);
+
+            // a rope and not a rod, no spring and only the upper limit
+            b2DistanceJointDef limit = b2DefaultDistanceJointDef();
+            connect(limit, bodyA, anchorA, bodyB, anchorB);
+            limit.length = configuration.length;
+            limit.enableSpring = true;
+            limit.hertz = 0.0f;
+            limit.enableLimit = true;
+            limit.minLength = 0.0f;
+            limit.maxLength = configuration.length;
+            _limitId = b2CreateDistanceJoint(worldId, &limit);
+
+            _vertices = Containers::Array<Vector2>{NoInit, std::size_t(count + 1)*2};
+            update();
+            _buffer.setData(_vertices, GL::BufferUsage::StreamDraw);
+            _mesh.setPrimitive(GL::MeshPrimitive::TriangleStrip)
+                .setCount(Int(_vertices.size()))
+                .addVertexBuffer(_buffer, 0, FlatShader::Position{});
+        }
+
+        Rope(const Rope &) = delete;
+        Rope &operator=(const Rope &) = delete;
+
+        ~Rope() {
+            // the world may be gone already at shutdown
+            if(!b2World_IsValid(_worldId)) return;
+
+            // the segments take their joints with them
+            if(b2Joint_IsValid(_limitId)) b2DestroyJoint(_limitId);
+            for(const b2BodyId segmentId: _segments) b2DestroyBody(segmentId);
+        }
+
+        [[nodiscard]] UnsignedInt getSegmentCount() const {
+            return UnsignedInt(_segments.size());
+        }
+
+        [[nodiscard]] Float getLength() const {
+            return _configuration.length;
+        }
+
+        /**
+         * Widest gap between two linked segment ends, a rope that is
+         * stable keeps this at a small fraction of a segment.
+         */
+        [[nodiscard]] Float getMaxJointGap() const {
+            Float gap = 0.0f;
+            for(std::size_t i = 0; i + 1 < _segments.size(); ++i) {
+                gap = Math::max(gap, b2Distance(b2Body_GetWorldPoint(_segments[i], {_halfLength, 0.0f}),
+                                                b2Body_GetWorldPoint(_segments[i + 1], {-_halfLength, 0.0f})));
+            }
+            return gap;
+        }
+
+        /// Move the segments by -@p shift, returns how many there are
+        std::size_t shiftOrigin(const Vector2 &shift) {
+            for(const b2BodyId segmentId: _segments) shiftBody(segmentId, shift);
+            return _segments.size();
+        }
+
+        /**
+         * Lay out the strip from the segment transforms. Only reads the
+         * world, the upload is left to draw() on the GL thread.
+         */
+        void update() {
+            Trace::Scope traceScope{"Rope::update"};
+
+            const std::size_t count = _segments.size();
+            // segment starts, then the end of the last one
+            const auto point = [&](const std::size_t i) {
+                const b2Vec2 p = i == count ? b2Body_GetWorldPoint(_segments[count - 1], {_halfLength, 0.0f})
+                                            : b2Body_GetWorldPoint(_segments[i], {-_halfLength, 0.0f});
+                return Vector2{p.x, p.y};
+            };
+
+            Vector2 previous = point(0);
+            Vector2 current = previous;
+            for(std::size_t i = 0; i <= count; ++i) {
+                const Vector2 next = i == count ? current : point(i + 1);
+                Vector2 tangent = next - previous;
+                const Float tangentLength = tangent.length();
+                tangent = tangentLength > 1.0e-6f ? tangent/tangentLength : Vector2::xAxis();
+
+                const Vector2 side = tangent.perpendicular()*_configuration.radius;
+                _vertices[i*2] = current + side;
+                _vertices[i*2 + 1] = current - side;
+
+                previous = current;
+                current = next;
+            }
+        }
+
+        void draw(const Matrix3 &transformationProjectionMatrix) {
+            // orphan and refill, the driver doesn't have to wait for the previous frame
+            _buffer.setData(_vertices, GL::BufferUsage::StreamDraw);
+            _shader.setTransformationProjectionMatrix(transformationProjectionMatrix)
+                .setColor(_configuration.color)
+                .draw(_mesh);
+        }
+
+    private:
+        // Box2D 3.2 moved the bodies and anchors of joint definitions into a common base
+        template<class Definition> static void connect(Definition &definition, const b2BodyId bodyA, const b2Vec2 anchorA,
+                                                       const b2BodyId bodyB, const b2Vec2 anchorB) {
+            if constexpr(requires { definition.localAnchorA; }) {
+                definition.bodyIdA = bodyA;
+                definition.bodyIdB = bodyB;
+                definition.localAnchorA = anchorA;
+                definition.localAnchorB = anchorB;
+            } else {
+                definition.base.bodyIdA = bodyA;
+                definition.base.bodyIdB = bodyB;
+                definition.base.localFrameA.p = anchorA;
+                definition.base.localFrameB.p = anchorB;
+            }
+        }
+
+        FlatShader &_shader;
+        b2WorldId _worldId;
+        Configuration _configuration;
+        Float _halfLength;
+
+        Containers::Array<b2BodyId> _segments;
+        b2JointId _limitId{};
+
+        Containers::Array<Vector2> _vertices;
+        GL::Buffer _buffer;
+        GL::Mesh _mesh;
+    };
+}
+
+#endif //MAGNUM_MOONLANDER_ROPE_H
@@ -0,0 +1,432 @@
+#ifndef MAGNUM_MOONLANDER_SCRIPT_H
+#define MAGNUM_MOONLANDER_SCRIPT_H
+
+#include <algorithm>
+#include <coroutine>
+#include <exception>
+#include <new>
+#include <utility>
+
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Containers/Pointer.h>
+#include <Corrade/Utility/Debug.h>
+
+#include <Magnum/Magnum.h>
+
+#include <box2d/box2d.h>
+
+#include "Trace.h"
+
+namespace Magnum::Game {
+    /**
+     * Size-class free lists for coroutine frames. Frames are carved from
+     * 64 kB chunks and go back to their free list when a script ends, so
+     * starting scripts doesn't touch the heap once the pool warmed up.
+     * Frames above the largest class fall back to operator new. Scripts
+     * run on the main thread only, the pool takes no locks.
+     */
+    class ScriptFramePool {
+    public:
+        static constexpr std::size_t Granularity = 64;
+        static constexpr std::size_t ClassCount = 16;
+        static constexpr std::size_t ChunkSize = 64*1024;
+
+        static ScriptFramePool &global() {
+            static ScriptFramePool pool;
+            return pool;
+        }
+
+        void *allocate(const std::size_t size) {
+            const std::size_t sizeClass = (size + Granularity - 1)/Granularity;
+            if(sizeClass > ClassCount) {
+                ++_fallbackCount;
+                return ::operator new(size);
+            }
+
+            ++_liveFrames;
+            if(FreeFrame *frame = _free[sizeClass - 1]) {
+                _free[sizeClass - 1] = frame->next;
+                return frame;
+            }
+
+            const std::size_t bytes = sizeClass*Granularity;
+            if(_chunks.isEmpty() || _chunkUsed + bytes > ChunkSize) {
+                Containers::arrayAppend(_chunks, Containers::Array<char>{NoInit, ChunkSize});
+                _chunkUsed = 0;
+            }
+
+            void *frame = _chunks[_chunks.size() - 1].data() + _chunkUsed;
+            _chunkUsed += bytes;
+            return frame;
+        }
+
+        void deallocate(void *pointer, const std::size_t size) {
+            const std::size_t sizeClass = (size + Granularity - 1)/Granularity;
+            if(sizeClass > ClassCount) {
+                ::operator delete(pointer);
+                return;
+            }
+
+            --_liveFrames;
+            _free[sizeClass - 1] = new(pointer) FreeFrame{_free[sizeClass - 1]};
+        }
+
+        [[nodiscard]] std::size_t getLiveFrameCount() const {
+            return _liveFrames;
+        }
+
+        [[nodiscard]] std::size_t getChunkBytes() const {
+            return _chunks.size()*ChunkSize;
+        }
+
+        /// Frames too large for the pool
+        [[nodiscard]] UnsignedLong getFallbackCount() const {
+            return _fallbackCount;
+        }
+
+    private:
+        struct FreeFrame {
+            FreeFrame *next;
+        };
+
+        FreeFrame *_free[ClassCount]{};
+        Containers::Array<Containers::Array<char>> _chunks;
+        std::size_t _chunkUsed = 0;
+        std::size_t _liveFrames = 0;
+        UnsignedLong _fallbackCount = 0;
+    };
+
+    class ScriptScheduler;
+
+    /**
+     * A level script, a coroutine that waits with co_await nextTick(),
+     * sleep() or waitFor() and is run by ScriptScheduler::start(). The
+     * references a script takes have to outlive it.
+     */
+    class Script {
+    public:
+        struct promise_type {
+            ScriptScheduler *scheduler = nullptr;
+            // list of live scripts, for destroying the suspended ones
+            promise_type *previous = nullptr;
+            promise_type *next = nullptr;
+
+            Script get_return_object() {
+                return Script{std::coroutine_handle<promise_type>::from_promise(*this)};
+            }
+
+            // starts suspended, ScriptScheduler::start() schedules the first resume
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+
+            static void *operator new(const std::size_t size) {
+                return ScriptFramePool::global().allocate(size);
+            }
+
+            static void operator delete(void *pointer, const std::size_t size) {
+                ScriptFramePool::global().deallocate(pointer, size);
+            }
+        };
+
+        using Handle = std::coroutine_handle<promise_type>;
+
+        explicit Script(const Handle handle): _handle(handle) {}
+
+        Script(const Script &) = delete;
+        Script(Script &&other) noexcept: _handle(std::exchange(other._handle, nullptr)) {}
+        Script &operator=(const Script &) = delete;
+        Script &operator=(Script &&other) noexcept {
+            std::swap(_handle, other._handle);
+            return *this;
+        }
+
+        // a script that was never started
+        ~Script() {
+            if(_handle) _handle.destroy();
+        }
+
+        /// Give up ownership, the scheduler takes it
+        Handle release() {
+            return std::exchange(_handle, nullptr);
+        }
+
+    private:
+        Handle _handle;
+    };
+
+    /**
+     * Edge-triggered event scripts wait for with co_await waitFor(). Firing
+     * wakes everything waiting at that moment; waiting costs nothing until
+     * then.
+     */
+    class Signal {
+    public:
+        void fire();
+
+        [[nodiscard]] std::size_t getWaitingCount() const {
+            return _waiting.size();
+        }
+
+    private:
+        friend struct WaitFor;
+
+        void remove(Script::Handle handle);
+
+        Containers::Array<Script::Handle> _waiting;
+    };
+
+    /**
+     * Runs scripts. Only scripts whose wake condition fired are resumed:
+     * sleeping ones sit in a min-heap and are looked at only once due, the
+     * ones waiting for a signal are referenced only by the signal.
+     */
+    class ScriptScheduler {
+    public:
+        ScriptScheduler() = default;
+        ScriptScheduler(const ScriptScheduler &) = delete;
+        ScriptScheduler &operator=(const ScriptScheduler &) = delete;
+
+        ~ScriptScheduler() {
+            // suspended scripts never finish, free their frames
+            while(_live) {
+                promise_type *promise = _live;
+                _live = promise->next;
+                Script::Handle::from_promise(*promise).destroy();
+            }
+        }
+
+        /// Start @p script, it first runs in the next update()
+        void start(Script script) {
+            const Script::Handle handle = script.release();
+            promise_type &promise = handle.promise();
+            promise.scheduler = this;
+            promise.next = _live;
+            if(_live) _live->previous = &promise;
+            _live = &promise;
+            ++_liveCount;
+
+            Containers::arrayAppend(_ready, handle);
+        }
+
+        /// Advance the script clock and resume every script that's due
+        void update(const Double dt) {
+            Trace::Scope traceScope{"ScriptScheduler::update"};
+
+            _time += dt;
+            _resumedCount = 0;
+
+            while(!_timers.isEmpty() && _timers[0].time <= _time) {
+                std::pop_heap(_timers.begin(), _timers.end(), laterTimer);
+                Containers::arrayAppend(_ready, _timers[_timers.size() - 1].handle);
+                Containers::arrayRemoveSuffix(_timers);
+            }
+
+            // signals fired by resumed scripts wake their waiters in this update still
+            while(!_ready.isEmpty()) {
+                std::swap(_ready, _resuming);
+                for(const Script::Handle handle: _resuming) {
+                    handle.resume();
+                    ++_resumedCount;
+                    if(handle.done()) finish(handle);
+                }
+                Containers::arrayClear(_resuming);
+            }
+
+            std::swap(_ready, _nextTick);
+            Trace::counter("scripts resumed", Double(_resumedCount));
+        }
+
+        /// Seconds of script time, advanced by update()
+        [[nodiscard]] Double getTime() const {
+            return _time;
+        }
+
+        [[nodiscard]] std::size_t getLiveCount() const {
+            return _liveCount;
+        }
+
+        [[nodiscard]] std::size_t getSleepingCount() const {
+            return _timers.size();
+        }
+
+        /// Scripts resumed by the last update()
+        [[nodiscard]] std::size_t getResumedCount() const {
+            return _resumedCount;
+        }
+
+        void print() const {
+            const ScriptFramePool &pool = ScriptFramePool::global();
+            Debug{} << "[scripts]" << _liveCount << "live," << _timers.size() << "sleeping,"
+                << pool.getLiveFrameCount() << "pooled frames in" << pool.getChunkBytes() << "bytes,"
+                << pool.getFallbackCount() << "frames outside the pool";
+        }
+
+    private:
+        friend struct NextTick;
+        friend struct Sleep;
+        friend class Signal;
+
+        using promise_type = Script::promise_type;
+
+        struct Timer {
+            Double time;
+            // keeps scripts due at the same time in the order they went to sleep
+            UnsignedLong sequence;
+            Script::Handle handle;
+        };
+
+        static bool laterTimer(const Timer &a, const Timer &b) {
+            return a.time > b.time || (a.time == b.time && a.sequence > b.sequence);
+        }
+
+        void wakeNextTick(const Script::Handle handle) {
+            Containers::arrayAppend(_nextTick, handle);
+        }
+
+        void wakeAt(const Script::Handle handle, const Double time) {
+            Containers::arrayAppend(_timers, Timer{time, _timerSequence++, handle});
+            std::push_heap(_timers.begin(), _timers.end(), laterTimer);
+        }
+
+        void wake(const Script::Handle handle) {
+            Containers::arrayAppend(_ready, handle);
+        }
+
+        void finish(const Script::Handle handle) {
+            promise_type &promise = handle.promise();
+            if(promise.previous) promise.previous->next = promise.next;
+            else _live = promise.next;
+            if(promise.next) promise.next->previous = promise.previous;
+            --_liveCount;
+            handle.destroy();
+        }
+
+        Double _time = 0.0;
+        promise_type *_live = nullptr;
+        std::size_t _liveCount = 0;
+        std::size_t _resumedCount = 0;
+
+        Containers::Array<Script::Handle> _ready;
+        Containers::Array<Script::Handle> _resuming;
+        Containers::Array<Script::Handle> _nextTick;
+        Containers::Array<Timer> _timers;
+        UnsignedLong _timerSequence = 0;
+    };
+
+    inline void Signal::fire() {
+        for(const Script::Handle handle: _waiting) {
+            handle.promise().scheduler->wake(handle);
+        }
+        Containers::arrayClear(_waiting);
+    }
+
+    inline void Signal::remove(const Script::Handle handle) {
+        // from the back, ~ScriptScheduler destroys the newest scripts first
+        for(std::size_t i = _waiting.size(); i != 0; --i) {
+            if(_waiting[i - 1] != handle) continue;
+            // keep the rest waking in the order they started waiting
+            for(std::size_t j = i; j != _waiting.size(); ++j)
+                _waiting[j - 1] = _waiting[j];
+            Containers::arrayRemoveSuffix(_waiting);
+            return;
+        }
+    }
+
+    struct NextTick {
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(const Script::Handle handle) const {
+            handle.promise().scheduler->wakeNextTick(handle);
+        }
+        void await_resume() const noexcept {}
+    };
+
+    struct Sleep {
+        Double seconds;
+
+        bool await_ready() const noexcept { return seconds <= 0.0; }
+        void await_suspend(const Script::Handle handle) const {
+            ScriptScheduler &scheduler = *handle.promise().scheduler;
+            scheduler.wakeAt(handle, scheduler.getTime() + seconds);
+        }
+        void await_resume() const noexcept {}
+    };
+
+    struct WaitFor {
+        Signal &signal;
+        Script::Handle handle{};
+
+        // lives in the coroutine frame, so this also runs when the scheduler
+        // destroys a script still waiting, which mustn't stay in the signal
+        ~WaitFor() {
+            if(handle) signal.remove(handle);
+        }
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(const Script::Handle suspended) {
+            handle = suspended;
+            Containers::arrayAppend(signal._waiting, suspended);
+        }
+        void await_resume() const noexcept {}
+    };
+
+    /// Continue in the next ScriptScheduler::update()
+    inline NextTick nextTick() {
+        return {};
+    }
+
+    /// Continue once @p seconds of script time passed
+    inline Sleep sleep(const Double seconds) {
+        return {seconds};
+    }
+
+    /// Continue once @p signal fires
+    inline WaitFor waitFor(Signal &signal) {
+        return {signal};
+    }
+
+    /**
+     * Signals fired when two bodies start touching, from the begin touch
+     * events of a world step.
+     */
+    class ContactSignals {
+    public:
+        /// Signal for @p a and @p b touching, in either order
+        Signal &between(const b2BodyId a, const b2BodyId b) {
+            for(Pair &pair: _pairs) {
+                if((B2_ID_EQUALS(pair.a, a) && B2_ID_EQUALS(pair.b, b))
+                    || (B2_ID_EQUALS(pair.a, b) && B2_ID_EQUALS(pair.b, a))) {
+                    return *pair.signal;
+                }
+            }
+
+            Containers::arrayAppend(_pairs, Pair{a, b, Containers::pointer<Signal>()});
+            return *_pairs[_pairs.size() - 1].signal;
+        }
+
+        void update(const b2ContactEvents &events) {
+            for(Int i = 0; i != events.beginCount; ++i) {
+                const b2BodyId a = b2Shape_GetBody(events.beginEvents[i].shapeIdA);
+                const b2BodyId b = b2Shape_GetBody(events.beginEvents[i].shapeIdB);
+                for(Pair &pair: _pairs) {
+                    if((B2_ID_EQUALS(pair.a, a) && B2_ID_EQUALS(pair.b, b))
+                        || (B2_ID_EQUALS(pair.a, b) && B2_ID_EQUALS(pair.b, a))) {
+                        pair.signal->fire();
+                    }
+                }
+            }
+        }
+
+    private:
+        struct Pair {
+            b2BodyId a, b;
+            // signal references stay valid as pairs get added
+            Containers::Pointer<Signal> signal;
+        };
+
+        Containers::Array<Pair> _pairs;
+    };
+}
+
+#endif //MAGNUM_MOONLANDER_SCRIPT_H
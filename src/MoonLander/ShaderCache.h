@@ -0,0 +1,237 @@
+#ifndef MAGNUM_MOONLANDER_SHADERCACHE_H
+#define MAGNUM_MOONLANDER_SHADERCACHE_H
+
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <initializer_list>
+#include <string>
+#include <unordered_map>
+
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/Pointer.h>
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/Utility/DebugStl.h>
+#include <Corrade/Utility/Path.h>
+
+#include <Magnum/GL/Context.h>
+#include <Magnum/GL/Extensions.h>
+#include <Magnum/GL/OpenGL.h>
+
+#include "FlatShader.h"
+
+namespace Magnum::Game {
+    /**
+     * Shared registry of compiled shader variants. Every owner asks the
+     * cache for the flags it needs, so a variant is compiled once no
+     * matter how many objects draw with it.
+     *
+     * precompile() submits all variants known up front before waiting for
+     * any of them, which lets drivers with KHR_parallel_shader_compile link
+     * them side by side.
+     *
+     * With setBinaryDirectory() linked programs are kept on disk as
+     * ARB_get_program_binary blobs, keyed by flags and a hash of the
+     * driver strings and shader sources. Later runs load them instead of
+     * compiling; a binary the driver rejects is compiled and written
+     * again. Mesa, llvmpipe included, offers a binary format whenever its
+     * own shader cache is enabled.
+     */
+    class ShaderCache {
+    public:
+        using Flags = FlatShader::Flags;
+
+        /**
+         * Keep program binaries in @p directory, empty turns it off. Needs
+         * a current GL context, call before the first variant is
+         * requested. Without a binary format to use it stays off.
+         */
+        void setBinaryDirectory(const std::string &directory) {
+            _directory = {};
+            if(directory.empty()) return;
+            if(!binaryFormatCount()) {
+                Warning{} << "[shaders] the driver has no program binary formats, not caching shaders in" << directory;
+                return;
+            }
+
+            _directory = directory;
+            _driverHash = driverHash();
+        }
+
+        /// Compile all @p variants that aren't in the cache yet, in parallel where the driver can
+        void precompile(const std::initializer_list<Flags> variants) {
+            const auto begin = std::chrono::steady_clock::now();
+
+            Containers::Array<FlatShader::CompileState> states;
+            for(const Flags flags: variants) {
+                if(_shaders.find(key(flags)) != _shaders.end() || load(flags)) continue;
+                Containers::arrayAppend(states, FlatShader::compile(flags, !_directory.empty()));
+            }
+
+            // linking finishes here, all programs were submitted above
+            for(FlatShader::CompileState &state: states) {
+                const Flags flags = state.getFlags();
+                save(*_shaders.emplace(key(flags), Containers::pointer<FlatShader>(std::move(state))).first->second);
+            }
+
+            _compiledCount += UnsignedInt(states.size());
+            _compileMilliseconds += millisecondsSince(begin);
+        }
+
+        /// Shader with @p flags, loaded or compiled on first use
+        FlatShader &flat(const Flags flags) {
+            const auto found = _shaders.find(key(flags));
+            if(found != _shaders.end()) {
+                ++_hitCount;
+                return *found->second;
+            }
+
+            const auto begin = std::chrono::steady_clock::now();
+            if(FlatShader *loaded = load(flags)) {
+                _compileMilliseconds += millisecondsSince(begin);
+                return *loaded;
+            }
+
+            FlatShader &shader = *_shaders.emplace(key(flags),
+                Containers::pointer<FlatShader>(FlatShader::compile(flags, !_directory.empty())))
+                .first->second;
+            save(shader);
+
+            ++_compiledCount;
+            _compileMilliseconds += millisecondsSince(begin);
+            return shader;
+        }
+
+        [[nodiscard]] std::size_t getVariantCount() const {
+            return _shaders.size();
+        }
+
+        /// Variants created from a cached program binary
+        [[nodiscard]] UnsignedInt getLoadedCount() const {
+            return _loadedCount;
+        }
+
+        /// Requests served by an already compiled variant
+        [[nodiscard]] UnsignedInt getHitCount() const {
+            return _hitCount;
+        }
+
+        /// Time spent compiling, linking and loading binaries so far
+        [[nodiscard]] Double getCompileMilliseconds() const {
+            return _compileMilliseconds;
+        }
+
+        void print() const {
+            GL::Context &context = GL::Context::current();
+
+            Debug{} << "[shaders]" << _loadedCount << "variants loaded from cached binaries," << _compiledCount
+                << "compiled, in" << _compileMilliseconds << "ms," << _hitCount << "requests shared an existing variant";
+            if(_rejectedCount) {
+                Debug{} << "[shaders]" << _rejectedCount << "cached binaries were rejected by the driver and recompiled";
+            }
+            Debug{} << "[shaders] driver" << context.versionString() << Debug::nospace << ","
+                << binaryFormatCount() << "program binary formats, binary cache"
+                << (_directory.empty() ? std::string{"off"} : _directory) << Debug::nospace << ", parallel compile"
+                << (context.isExtensionSupported<GL::Extensions::KHR::parallel_shader_compile>() ? "on" : "off");
+        }
+
+    private:
+        // in front of the driver's blob in every cache file
+        struct BinaryHeader {
+            UnsignedInt magic;
+            UnsignedInt format;
+        };
+        static constexpr UnsignedInt BinaryMagic = 0x42464c4d; // "MLFB"
+
+        static UnsignedInt key(const Flags flags) {
+            return UnsignedInt(Flags::UnderlyingType(flags));
+        }
+
+        static Double millisecondsSince(const std::chrono::steady_clock::time_point begin) {
+            return std::chrono::duration<Double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        }
+
+        static Int binaryFormatCount() {
+            GLint formats = 0;
+#if !defined(MAGNUM_TARGET_GLES2) && !defined(MAGNUM_TARGET_WEBGL)
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+#endif
+            return formats;
+        }
+
+        // a binary only loads on the driver build that produced it, and only matches the sources it was built from
+        static UnsignedLong driverHash() {
+            GL::Context &context = GL::Context::current();
+
+            // FNV-1a over all strings
+            UnsignedLong value = 14695981039346656037ull;
+            const auto add = [&value](const auto &string) {
+                for(const char c: string) value = (value ^ UnsignedByte(c))*1099511628211ull;
+                value = (value ^ 0xff)*1099511628211ull;
+            };
+            add(context.vendorString());
+            add(context.rendererString());
+            add(context.versionString());
+            add(Containers::StringView{Implementation::FlatVertexSource});
+            add(Containers::StringView{Implementation::FlatFragmentSource});
+            return value;
+        }
+
+        std::string filename(const Flags flags) const {
+            return Utility::Path::join(_directory, std::format("flat-{:02x}-{:016x}.bin", key(flags), _driverHash));
+        }
+
+        // nullptr if there's no usable binary for @p flags
+        FlatShader *load(const Flags flags) {
+            if(_directory.empty()) return nullptr;
+
+            const std::string file = filename(flags);
+            if(!Utility::Path::exists(file)) return nullptr;
+
+            const Containers::Optional<Containers::Array<char>> data = Utility::Path::read(file);
+            BinaryHeader header{};
+            if(data && data->size() > sizeof(BinaryHeader)) std::memcpy(&header, data->data(), sizeof(BinaryHeader));
+            Containers::Optional<FlatShader> shader;
+            if(header.magic == BinaryMagic) {
+                shader = FlatShader::fromBinary(flags, GLenum(header.format), data->exceptPrefix(sizeof(BinaryHeader)));
+            }
+            if(!shader) {
+                ++_rejectedCount;
+                return nullptr;
+            }
+
+            ++_loadedCount;
+            return _shaders.emplace(key(flags), Containers::pointer<FlatShader>(std::move(*shader))).first->second.get();
+        }
+
+        void save(const FlatShader &shader) {
+            if(_directory.empty()) return;
+
+            GLenum format;
+            const Containers::Array<char> binary = shader.binary(format);
+            if(binary.isEmpty()) return;
+
+            Containers::Array<char> data{NoInit, sizeof(BinaryHeader) + binary.size()};
+            const BinaryHeader header{BinaryMagic, UnsignedInt(format)};
+            std::memcpy(data.data(), &header, sizeof(BinaryHeader));
+            std::memcpy(data.data() + sizeof(BinaryHeader), binary.data(), binary.size());
+
+            const std::string file = filename(shader.getFlags());
+            if(!Utility::Path::make(_directory) || !Utility::Path::write(file, Containers::arrayView(data))) {
+                Warning{} << "[shaders] can't write" << file;
+            }
+        }
+
+        std::unordered_map<UnsignedInt, Containers::Pointer<FlatShader>> _shaders;
+        std::string _directory;
+        UnsignedLong _driverHash = 0;
+        UnsignedInt _compiledCount = 0;
+        UnsignedInt _loadedCount = 0;
+        UnsignedInt _rejectedCount = 0;
+        UnsignedInt _hitCount = 0;
+        Double _compileMilliseconds = 0.0;
+    };
+}
+
+#endif //MAGNUM_MOONLANDER_SHADERCACHE_H
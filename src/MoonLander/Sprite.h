@@ -3,28 +3,32 @@
 
 #include <Magnum/GL/Texture.h>
 #include <Magnum/GL/Sampler.h>
-#include <Magnum/Shaders/Flat.h>
 #include <Magnum/Timeline.h>
 #include <Magnum/Animation/Track.h>
 #include <Magnum/Trade/MeshData.h>
 #include <Magnum/Math/Color.h>
 
+#include "FlatShader.h"
+
 namespace Magnum::Game {
 
     class Sprite {
     private:
-        Shaders::FlatGL2D &_shader;
+        FlatShader &_shader;
         GL::Texture2D &_texture;
         GL::Mesh &_mesh;
 
         Int _frameIndex = Int{0};
         Int _frameCount = Int{0};
 
+        // either _frameIndex or a slot owned by AnimationSystem
+        const Int *_frameSource = &_frameIndex;
+
         Vector2i _frameSize = Vector2i{16, 16};
         Vector2i _gridSize = Vector2i{1, 1};
 
     public:
-        Sprite(Shaders::FlatGL2D &shader, GL::Texture2D &texture, GL::Mesh &mesh, const Vector2i &frameSize):
+        Sprite(FlatShader &shader, GL::Texture2D &texture, GL::Mesh &mesh, const Vector2i &frameSize):
         _shader(shader), _texture(texture), _mesh(mesh), _frameSize(frameSize) {
 
 
@@ -35,6 +39,10 @@ namespace Magnum::Game {
             _frameCount = _gridSize.product();
         }
 
+        // _frameSource may point into the object itself
+        Sprite(const Sprite &) = delete;
+        Sprite &operator=(const Sprite &) = delete;
+
         void setFrameIndex(Int frameIndex) {
             if(const auto maxFrameIndex = _frameCount-1; frameIndex > maxFrameIndex ) {
                 Error() << "unable to set frame index" << frameIndex
@@ -43,14 +51,20 @@ namespace Magnum::Game {
             }
 
             _frameIndex = frameIndex;
+            _frameSource = &_frameIndex;
         }
 
-        [[nodiscard]] Int getFrameIndex() const {
-            return _frameIndex;
+        /**
+         * Read the frame index from an external location, usually a slot in
+         * AnimationSystem::frameIndices(), instead of the one set by
+         * setFrameIndex(). The location has to outlive the sprite.
+         */
+        void setFrameSource(const Int &frameSource) {
+            _frameSource = &frameSource;
         }
 
-        [[nodiscard]]  Int& getFrameIndexRef() {
-            return _frameIndex;
+        [[nodiscard]] Int getFrameIndex() const {
+            return *_frameSource;
         }
 
         [[nodiscard]] Int getFrameCount() const {
@@ -63,7 +77,7 @@ namespace Magnum::Game {
 
             _shader.setTextureMatrix(
                     Matrix3::scaling(1.0f/Vector2{_gridSize})*
-                    Matrix3::translation(Vector2{Vector2i{_frameIndex, 0}}));
+                    Matrix3::translation(Vector2{Vector2i{*_frameSource, 0}}));
 
             _shader.bindTexture(_texture).draw(_mesh);
         }
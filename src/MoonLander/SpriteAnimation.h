@@ -1,59 +1,50 @@
 #ifndef MAGNUM_MOONLANDER_SPRITEANIMATION_H
 #define MAGNUM_MOONLANDER_SPRITEANIMATION_H
 
-#include <Corrade/PluginManager/Manager.h>
-#include <Magnum/Timeline.h>
-#include <Magnum/Animation/Track.h>
-#include <Magnum/Animation/Player.h>
-#include <Magnum/GL/TextureFormat.h>
-#include <Magnum/Math/Functions.h>
-
+#include "AnimationSystem.h"
 #include "Sprite.h"
 
 namespace Magnum::Game {
+        /**
+         * Frame animation of a sprite sheet. The animation state lives in an
+         * AnimationSystem, which advances it together with every other track,
+         * this is only a handle controlling one of its tracks.
+         */
         class SpriteAnimation {
         public:
-            SpriteAnimation(Sprite &sprite, const Float frameDelay) :
-            _sprite(sprite) {
-                Containers::Array<std::pair<Float, Int>> frames{static_cast<std::size_t>(_sprite.getFrameCount())};
-
-                Float frameTime = 0.0f;
-                for(std::size_t i = 0; i != frames.size(); ++i) {
-                    frames[i] = {frameTime, i};
-                    frameTime += frameDelay;
-                }
-                _frames = Animation::Track{std::move(frames), Math::select};
-
-                _player.addWithCallbackOnChange(
-                        _frames,
-                        [](Float, const Int& frame, SpriteAnimation& animation) {
-//                            Debug{} << "frame: " << frame;
-                            animation._sprite.setFrameIndex(frame);
-                            }, _sprite.getFrameIndexRef(), *this);
+            SpriteAnimation(AnimationSystem &animations, Sprite &sprite, const Float frameDelay) :
+            _animations(animations), _id(animations.add(sprite.getFrameCount(), frameDelay)) {
+                sprite.setFrameSource(_animations.frameIndex(_id));
             }
 
             void start() {
-                _timeline.start();
-                _player
-                    .setPlayCount(0)
-                    .play(_timeline.previousFrameTime());
+                _animations.seek(_id, 0.0f);
+                _animations.play(_id);
             }
 
             void pause() {
-                _player.pause(_timeline.previousFrameTime());
+                _animations.pause(_id);
             }
 
-            void tick() {
-                _player.advance(_timeline.previousFrameTime());
-                _timeline.nextFrame();
+            void resume() {
+                _animations.play(_id);
             }
 
-        private:
-            Sprite &_sprite;
+            void seek(const Float time) {
+                _animations.seek(_id, time);
+            }
+
+            void setRate(const Float rate) {
+                _animations.setRate(_id, rate);
+            }
+
+            [[nodiscard]] bool isPlaying() const {
+                return _animations.isPlaying(_id);
+            }
 
-            Animation::Track<Float, Int> _frames;
-            Animation::Player<Float> _player;
-            Timeline _timeline;
+        private:
+            AnimationSystem &_animations;
+            UnsignedInt _id;
         };
 
     } // Game
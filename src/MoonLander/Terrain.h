@@ -0,0 +1,255 @@
+#ifndef MAGNUM_MOONLANDER_TERRAIN_H
+#define MAGNUM_MOONLANDER_TERRAIN_H
+
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/ArrayView.h>
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Utility/Assert.h>
+#include <Magnum/GL/Buffer.h>
+#include <Magnum/GL/Mesh.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Vector2.h>
+#include <Magnum/Shaders/Flat.h>
+
+#include <box2d/box2d.h>
+
+#include "Game.h"
+#include "Collision.h"
+#include "FloatingOrigin.h"
+
+namespace Magnum::Game {
+    /**
+     * Destructible heightfield ground. The surface is sampled in columns of
+     * equal width and split into segments, each segment is one Box2D chain
+     * and one range of the triangle strip vertex buffer. Carving a crater
+     * only marks the segments it touches, rebuild() then recreates their
+     * chains and re-uploads their part of the buffer in place, so the cost
+     * follows the crater size and not the terrain size.
+     *
+     * Heights and vertices are kept relative to the terrain's own origin,
+     * shiftOrigin() only moves the body and the public functions take
+     * world positions.
+     */
+    class Terrain {
+    public:
+        struct Configuration {
+            Float left = -20.0f;
+            Float right = 20.0f;
+            Float surface = -9.0f;
+            Float bottom = -14.0f;
+            Float columnWidth = 0.25f;
+            /// Columns per chain / buffer segment, at most MaxSegmentColumns
+            Int segmentColumns = 16;
+            /// Craters never cut deeper than this above the bottom
+            Float minThickness = 0.5f;
+            /// Slowest impact that carves a crater
+            Float craterSpeed = 4.0f;
+            Float craterRadiusPerSpeed = 0.12f;
+            Float maxCraterRadius = 3.0f;
+        };
+
+        static constexpr Int MaxSegmentColumns = 64;
+
+        Terrain(const b2WorldId worldId, const Configuration &configuration): _configuration(configuration) {
+            CORRADE_INTERNAL_ASSERT(configuration.segmentColumns > 0 &&
+                                    configuration.segmentColumns <= MaxSegmentColumns);
+
+            const Int columns = Math::max(1, Int((_configuration.right - _configuration.left)/_configuration.columnWidth));
+            _pointCount = columns + 1;
+            _segmentCount = (columns + _configuration.segmentColumns - 1)/_configuration.segmentColumns;
+
+            _heights = Containers::Array<Float>{DirectInit, std::size_t(_pointCount), _configuration.surface};
+            _vertices = Containers::Array<Vector2>{NoInit, std::size_t(_pointCount*2)};
+            for(Int i = 0; i != _pointCount; ++i) {
+                updateVertices(i);
+            }
+
+            _chains = Containers::Array<b2ChainId>{ValueInit, std::size_t(_segmentCount)};
+            _dirty = Containers::Array<bool>{ValueInit, std::size_t(_segmentCount)};
+            Containers::arrayReserve(_dirtySegments, _segmentCount);
+
+            b2BodyDef bodyDefinition = b2DefaultBodyDef();
+            bodyDefinition.type = b2_staticBody;
+            _bodyId = b2CreateBody(worldId, &bodyDefinition);
+
+            _buffer.setData(_vertices, GL::BufferUsage::DynamicDraw);
+            _mesh.setPrimitive(GL::MeshPrimitive::TriangleStrip)
+                .setCount(_pointCount*2)
+                .addVertexBuffer(_buffer, 0, Shaders::FlatGL2D::Position{});
+
+            for(Int segment = 0; segment != _segmentCount; ++segment) {
+                rebuildChain(segment);
+            }
+        }
+
+        [[nodiscard]] b2BodyId getBodyId() const {
+            return _bodyId;
+        }
+
+        [[nodiscard]] GL::Mesh &getMesh() {
+            return _mesh;
+        }
+
+        [[nodiscard]] Int getSegmentCount() const {
+            return _segmentCount;
+        }
+
+        /// Segments rebuilt since construction
+        [[nodiscard]] UnsignedLong getRebuiltSegmentCount() const {
+            return _rebuiltSegments;
+        }
+
+        /// Where the terrain's own origin is in the world, moved by shiftOrigin()
+        [[nodiscard]] Vector2 getOrigin() const {
+            return _origin;
+        }
+
+        /// Surface height at @p x, clamped to the terrain extent
+        [[nodiscard]] Float heightAt(const Float x) const {
+            const Float position = Math::clamp((x - _origin.x() - _configuration.left)/_configuration.columnWidth,
+                                               0.0f, Float(_pointCount - 1));
+            const Int i = Math::min(Int(position), _pointCount - 2);
+            return Math::lerp(_heights[i], _heights[i + 1], position - Float(i)) + _origin.y();
+        }
+
+        /// Move the terrain by -@p shift, chains and vertices stay as they are
+        void shiftOrigin(const Vector2 &shift) {
+            shiftBody(_bodyId, shift);
+            _origin -= shift;
+        }
+
+        /// Cut a circular crater, takes effect on the next rebuild()
+        void carve(const Vector2 &worldCenter, const Float radius) {
+            const Vector2 center = worldCenter - _origin;
+            const Float floor = _configuration.bottom + _configuration.minThickness;
+            const Int first = Math::max(0, Int(Math::ceil((center.x() - radius - _configuration.left)/_configuration.columnWidth)));
+            const Int last = Math::min(_pointCount - 1, Int(Math::floor((center.x() + radius - _configuration.left)/_configuration.columnWidth)));
+            if(first > last) return;
+
+            bool changed = false;
+            for(Int i = first; i <= last; ++i) {
+                const Float dx = pointX(i) - center.x();
+                const Float height = Math::max(center.y() - Math::sqrt(Math::max(radius*radius - dx*dx, 0.0f)), floor);
+                if(height < _heights[i]) {
+                    _heights[i] = height;
+                    updateVertices(i);
+                    changed = true;
+                }
+            }
+
+            if(!changed) return;
+
+            // chains use their neighbour's points as ghost vertices, mark those too
+            const Int firstSegment = Math::clamp((first - 2)/_configuration.segmentColumns, 0, _segmentCount - 1);
+            const Int lastSegment = Math::clamp((last + 1)/_configuration.segmentColumns, 0, _segmentCount - 1);
+            for(Int segment = firstSegment; segment <= lastSegment; ++segment) {
+                if(_dirty[segment]) continue;
+                _dirty[segment] = true;
+                Containers::arrayAppend(_dirtySegments, UnsignedInt(segment));
+            }
+        }
+
+        /// Carve craters where fast bodies hit the terrain, needs hit events enabled on them
+        void applyImpacts(const b2ContactEvents &events) {
+            for(Int i = 0; i != events.hitCount; ++i) {
+                const b2ContactHitEvent &hit = events.hitEvents[i];
+                if(hit.approachSpeed < _configuration.craterSpeed) continue;
+                if(!isTerrainShape(hit.shapeIdA) && !isTerrainShape(hit.shapeIdB)) continue;
+
+                const Float radius = Math::min(hit.approachSpeed*_configuration.craterRadiusPerSpeed,
+                                               _configuration.maxCraterRadius);
+                carve({hit.point.x, hit.point.y}, radius);
+            }
+        }
+
+        /// Recreate chains and re-upload vertices of segments changed by carve()
+        std::size_t rebuild() {
+            const std::size_t count = _dirtySegments.size();
+            for(const UnsignedInt segment: _dirtySegments) {
+                rebuildChain(Int(segment));
+
+                const Int first = firstPoint(Int(segment));
+                const Int last = lastPoint(Int(segment));
+                _buffer.setSubData(first*2*sizeof(Vector2),
+                                   _vertices.slice(std::size_t(first*2), std::size_t(last*2 + 2)));
+
+                _dirty[segment] = false;
+            }
+
+            _rebuiltSegments += count;
+            Containers::arrayClear(_dirtySegments);
+            return count;
+        }
+
+    private:
+        [[nodiscard]] Float pointX(const Int i) const {
+            return _configuration.left + Float(i)*_configuration.columnWidth;
+        }
+
+        [[nodiscard]] Int firstPoint(const Int segment) const {
+            return segment*_configuration.segmentColumns;
+        }
+
+        [[nodiscard]] Int lastPoint(const Int segment) const {
+            return Math::min((segment + 1)*_configuration.segmentColumns, _pointCount - 1);
+        }
+
+        [[nodiscard]] bool isTerrainShape(const b2ShapeId shapeId) const {
+            const b2BodyId bodyId = b2Shape_GetBody(shapeId);
+            return B2_ID_EQUALS(bodyId, _bodyId);
+        }
+
+        void updateVertices(const Int i) {
+            _vertices[i*2] = {pointX(i), _heights[i]};
+            _vertices[i*2 + 1] = {pointX(i), _configuration.bottom};
+        }
+
+        /// Surface point, indices past either end are extrapolated as ghosts
+        [[nodiscard]] b2Vec2 chainPoint(const Int i) const {
+            const Int clamped = Math::clamp(i, 0, _pointCount - 1);
+            return {pointX(i), _heights[clamped]};
+        }
+
+        void rebuildChain(const Int segment) {
+            if(B2_IS_NON_NULL(_chains[segment])) {
+                b2DestroyChain(_chains[segment]);
+            }
+
+            /* Open chains collide on their right side and use the first and
+               last point as ghost vertices only, so go right to left with
+               one extra point on each end */
+            b2Vec2 points[MaxSegmentColumns + 3];
+            Int count = 0;
+            for(Int i = lastPoint(segment) + 1; i >= firstPoint(segment) - 1; --i) {
+                points[count++] = chainPoint(i);
+            }
+
+            b2ChainDef chainDefinition = b2DefaultChainDef();
+            chainDefinition.points = points;
+            chainDefinition.count = count;
+            chainDefinition.isLoop = false;
+            chainDefinition.filter = CollisionFilter::terrain().toBox2D();
+            _chains[segment] = b2CreateChain(_bodyId, &chainDefinition);
+        }
+
+        Configuration _configuration;
+        Vector2 _origin;
+
+        Int _pointCount;
+        Int _segmentCount;
+
+        Containers::Array<Float> _heights;
+        Containers::Array<Vector2> _vertices;
+
+        b2BodyId _bodyId{};
+        Containers::Array<b2ChainId> _chains;
+        Containers::Array<bool> _dirty;
+        Containers::Array<UnsignedInt> _dirtySegments;
+        UnsignedLong _rebuiltSegments = 0;
+
+        GL::Buffer _buffer;
+        GL::Mesh _mesh;
+    };
+}
+
+#endif //MAGNUM_MOONLANDER_TERRAIN_H
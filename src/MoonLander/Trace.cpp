@@ -0,0 +1,157 @@
+#include "Trace.h"
+
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <Corrade/Containers/String.h>
+#include <Corrade/Utility/Debug.h>
+
+namespace Magnum::Game {
+    namespace {
+        // 2^16 events of 32 bytes, 2 MB per thread, about a minute of ticks
+        constexpr std::size_t EventCapacity = 1 << 16;
+        static_assert(!(EventCapacity & (EventCapacity - 1)), "the ring index needs a power of two");
+
+        struct Event {
+            const char *name;
+            UnsignedLong begin;
+            union {
+                UnsignedLong duration;
+                Double value;
+            };
+            Trace::EventType type;
+        };
+
+        struct ThreadBuffer {
+            UnsignedInt id;
+            std::atomic<const char *> name;
+            /* Events ever recorded, the last EventCapacity of them are kept
+               in a ring. Written by the owning thread only, published with
+               release. */
+            std::atomic<std::size_t> count{0};
+            std::unique_ptr<Event[]> events{new Event[EventCapacity]};
+        };
+
+        struct Registry {
+            std::mutex mutex;
+            std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+        };
+
+        Registry &registry() {
+            static Registry registry;
+            return registry;
+        }
+
+        thread_local ThreadBuffer *threadBuffer = nullptr;
+
+        // registration locks once per thread, recording after that doesn't
+        ThreadBuffer &currentThreadBuffer() {
+            if(!threadBuffer) {
+                Registry &r = registry();
+                std::lock_guard<std::mutex> lock{r.mutex};
+                auto buffer = std::make_unique<ThreadBuffer>();
+                buffer->id = UnsignedInt(r.buffers.size() + 1);
+                buffer->name = r.buffers.empty() ? "Main" : "Thread";
+                threadBuffer = buffer.get();
+                r.buffers.push_back(std::move(buffer));
+            }
+
+            return *threadBuffer;
+        }
+
+        // a full buffer overwrites its oldest events, a long session keeps its tail
+        void record(const Event &event) {
+            ThreadBuffer &buffer = currentThreadBuffer();
+            const std::size_t count = buffer.count.load(std::memory_order_relaxed);
+            buffer.events[count & (EventCapacity - 1)] = event;
+            buffer.count.store(count + 1, std::memory_order_release);
+        }
+    }
+
+    void Trace::setEnabled(const bool enabled) {
+        origin();
+        // allocate the calling thread's buffer now instead of inside the first span
+        if(enabled) currentThreadBuffer();
+        enabledFlag().store(enabled, std::memory_order_relaxed);
+    }
+
+    void Trace::setThreadName(const char *name) {
+        currentThreadBuffer().name = name;
+    }
+
+    void Trace::span(const char *name, const UnsignedLong begin, const UnsignedLong end) {
+        Event event{name, begin, {}, EventType::Span};
+        event.duration = end - begin;
+        record(event);
+    }
+
+    void Trace::counter(const char *name, const Double value) {
+        if(!isEnabled()) return;
+
+        Event event{name, now(), {}, EventType::Counter};
+        event.value = value;
+        record(event);
+    }
+
+    bool Trace::write(const Containers::StringView filename) {
+        std::FILE *file = std::fopen(Containers::String::nullTerminatedView(filename).data(), "wb");
+        if(!file) {
+            Error{} << "[trace] can't open" << filename << "for writing";
+            return false;
+        }
+
+        std::size_t written = 0;
+        std::size_t overwritten = 0;
+
+        std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file);
+
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock{r.mutex};
+        bool first = true;
+        for(const auto &buffer: r.buffers) {
+            std::fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                first ? "" : ",\n", buffer->id, buffer->name.load());
+            first = false;
+
+            const std::size_t count = buffer->count.load(std::memory_order_acquire);
+            const std::size_t oldest = count > EventCapacity ? count - EventCapacity : 0;
+            for(std::size_t i = oldest; i != count; ++i) {
+                const Event event = buffer->events[i & (EventCapacity - 1)];
+                /* Other threads keep recording during an F9 write. Skip the
+                   event if its slot may have been reused while copying it,
+                   the owner writes slot i again once its count reaches
+                   i + EventCapacity. */
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if(buffer->count.load(std::memory_order_relaxed) - i >= EventCapacity) {
+                    ++overwritten;
+                    continue;
+                }
+
+                ++written;
+                if(event.type == EventType::Span) {
+                    std::fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                        event.name, buffer->id, Double(event.begin)/1000.0, Double(event.duration)/1000.0);
+                } else {
+                    std::fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"args\":{\"value\":%g}}",
+                        event.name, buffer->id, Double(event.begin)/1000.0, event.value);
+                }
+            }
+
+            // events older than the ring buffer holds
+            overwritten += oldest;
+        }
+
+        std::fputs("\n]}\n", file);
+        std::fclose(file);
+
+        Debug{} << "[trace] wrote" << written << "events from" << r.buffers.size() << "threads to" << filename;
+        if(overwritten) {
+            Debug{} << "[trace]" << overwritten << "older events were overwritten, the trace holds the last"
+                << EventCapacity << "events of every thread";
+        }
+
+        return true;
+    }
+}
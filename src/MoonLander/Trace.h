@@ -0,0 +1,88 @@
+#ifndef MAGNUM_MOONLANDER_TRACE_H
+#define MAGNUM_MOONLANDER_TRACE_H
+
+#include <atomic>
+#include <chrono>
+
+#include <Corrade/Containers/StringView.h>
+
+#include <Magnum/Magnum.h>
+
+namespace Magnum::Game {
+    /**
+     * Scoped span tracing of the game loop, written out as Chrome trace
+     * JSON (loadable in chrome://tracing and ui.perfetto.dev).
+     *
+     * Every thread records into its own fixed-size ring buffer, which only
+     * that thread writes to, so recording takes no locks. Once a ring is
+     * full the oldest events are overwritten, the trace keeps the most
+     * recent stretch of a long session. Recording is off until
+     * setEnabled(true); while off a Scope costs one relaxed atomic load.
+     */
+    class Trace {
+    public:
+        enum class EventType: UnsignedByte {
+            Span,
+            Counter
+        };
+
+        static bool isEnabled() {
+            return enabledFlag().load(std::memory_order_relaxed);
+        }
+
+        /// Enable recording, the first call also sets the time origin
+        static void setEnabled(bool enabled);
+
+        /// Name of the calling thread's track, @p name has to be a literal
+        static void setThreadName(const char *name);
+
+        /// Nanoseconds since the trace time origin
+        static UnsignedLong now() {
+            return UnsignedLong(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - origin()).count());
+        }
+
+        /// Record a finished span on the calling thread's track
+        static void span(const char *name, UnsignedLong begin, UnsignedLong end);
+
+        /// Record a counter value, shown as a graph in the trace viewer
+        static void counter(const char *name, Double value);
+
+        /// Write everything recorded so far as Chrome trace JSON
+        static bool write(Containers::StringView filename);
+
+        /**
+         * Records a span from construction to destruction. The name has to
+         * be a string literal, only the pointer is stored.
+         */
+        class Scope {
+        public:
+            explicit Scope(const char *name): _name(name), _enabled(isEnabled()), _begin(_enabled ? now() : 0) {}
+
+            ~Scope() {
+                if(_enabled) span(_name, _begin, now());
+            }
+
+            Scope(const Scope &) = delete;
+            Scope &operator=(const Scope &) = delete;
+
+        private:
+            const char *_name;
+            bool _enabled;
+            UnsignedLong _begin;
+        };
+
+    private:
+        static std::atomic<bool> &enabledFlag() {
+            static std::atomic<bool> enabled{false};
+            return enabled;
+        }
+
+        static std::chrono::steady_clock::time_point &origin() {
+            static std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+            return origin;
+        }
+    };
+}
+
+#endif //MAGNUM_MOONLANDER_TRACE_H
@@ -0,0 +1,254 @@
+#ifndef MAGNUM_MOONLANDER_WORKERPOOL_H
+#define MAGNUM_MOONLANDER_WORKERPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <Corrade/Containers/GrowableArray.h>
+
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Functions.h>
+
+#include <box2d/box2d.h>
+
+#include "Trace.h"
+
+namespace Magnum::Game {
+    /**
+     * Fixed set of worker threads shared by the frame's job graph and the
+     * Box2D solver. The thread that created the pool is thread 0 and helps
+     * out while it waits, so a pool without workers runs everything on it
+     * in submission order.
+     *
+     * Tasks are plain function pointers over an index range, submitting
+     * doesn't allocate once the queue has grown to its working size.
+     */
+    class WorkerPool {
+    public:
+        struct Configuration {
+            /// Threads besides the creating one, the default leaves one core for the driver
+            UnsignedInt workerCount = defaultWorkerCount();
+        };
+
+        /// Counts tasks not finished yet, see wait()
+        class TaskGroup {
+        public:
+            [[nodiscard]] bool isDone() const {
+                return _pending.load(std::memory_order_acquire) == 0;
+            }
+
+        private:
+            friend WorkerPool;
+
+            std::atomic<UnsignedInt> _pending{0};
+        };
+
+        /// Called with an index range and the index of the thread running it
+        using TaskFunction = void(*)(void *context, UnsignedInt begin, UnsignedInt end, UnsignedInt threadIndex);
+
+        static UnsignedInt defaultWorkerCount() {
+            const UnsignedInt cores = std::thread::hardware_concurrency();
+            return Math::clamp(cores, 2u, MaxWorkers + 2) - 2;
+        }
+
+        /// Index of the calling thread, 0 for the thread that created the pool
+        static UnsignedInt threadIndex() {
+            return currentThreadIndex();
+        }
+
+        WorkerPool(): WorkerPool{Configuration{}} {}
+
+        explicit WorkerPool(const Configuration &configuration) {
+            const UnsignedInt workerCount = Math::min(configuration.workerCount, MaxWorkers);
+            Containers::arrayReserve(_threads, workerCount);
+            for(UnsignedInt i = 0; i != workerCount; ++i) {
+                Containers::arrayAppend(_threads, InPlaceInit, [this, i]{ workerLoop(i + 1); });
+            }
+        }
+
+        WorkerPool(const WorkerPool &) = delete;
+        WorkerPool &operator=(const WorkerPool &) = delete;
+
+        ~WorkerPool() {
+            {
+                std::lock_guard<std::mutex> lock{_mutex};
+                _stopping = true;
+            }
+            _wake.notify_all();
+            for(std::thread &thread: _threads) thread.join();
+        }
+
+        /// Workers plus the creating thread, the worker count Box2D gets
+        [[nodiscard]] UnsignedInt getThreadCount() const {
+            return UnsignedInt(_threads.size()) + 1;
+        }
+
+        /// Queue @p function over [@p begin, @p end), counted in @p group
+        void submit(TaskGroup &group, const TaskFunction function, void *const context,
+                    const UnsignedInt begin, const UnsignedInt end) {
+            group._pending.fetch_add(1, std::memory_order_relaxed);
+            {
+                std::lock_guard<std::mutex> lock{_mutex};
+                Containers::arrayAppend(_queue, Task{function, context, begin, end, &group});
+            }
+            _wake.notify_one();
+        }
+
+        /// Run queued tasks on the calling thread until everything in @p group is done
+        void wait(const TaskGroup &group) {
+            const UnsignedInt thread = currentThreadIndex();
+            while(!group.isDone()) {
+                if(!runOne(thread)) std::this_thread::yield();
+            }
+        }
+
+        /// Run one queued task on the calling thread, false if there was none
+        bool runQueuedTask() {
+            return runOne(currentThreadIndex());
+        }
+
+        /**
+         * Split [0, @p count) into about as many chunks as there are
+         * threads, each at least @p minChunk long, run @p function on them
+         * and wait. The calling thread takes part.
+         */
+        template<class F> void parallelFor(const UnsignedInt count, const UnsignedInt minChunk, F &&function) {
+            if(count == 0) return;
+
+            const UnsignedInt chunk = Math::max(minChunk, (count + getThreadCount() - 1)/getThreadCount());
+            TaskGroup group;
+            for(UnsignedInt begin = 0; begin < count; begin += chunk) {
+                submit(group, [](void *context, const UnsignedInt begin, const UnsignedInt end, const UnsignedInt thread) {
+                    (*static_cast<F*>(context))(begin, end, thread);
+                }, &function, begin, Math::min(begin + chunk, count));
+            }
+            wait(group);
+        }
+
+        /**
+         * Box2D b2EnqueueTaskCallback running solver stages on the pool,
+         * each chunk a span on the track of the thread running it. Pass to
+         * b2WorldDef::enqueueTask together with finishBox2DTask(), the pool
+         * as b2WorldDef::userTaskContext and getThreadCount() as
+         * b2WorldDef::workerCount.
+         */
+        static void *enqueueBox2DTask(b2TaskCallback *task, const int itemCount, const int minRange,
+                                      void *taskContext, void *userContext) {
+            WorkerPool &pool = *static_cast<WorkerPool*>(userContext);
+
+            Box2DTask &slot = pool._box2DTasks[pool._nextBox2DTask];
+            // all slots still running, Box2D never has this many in flight but stay correct anyway
+            if(!slot.group.isDone()) {
+                Trace::Scope scope{"b2Task"};
+                task(0, itemCount, currentThreadIndex(), taskContext);
+                return nullptr;
+            }
+            pool._nextBox2DTask = (pool._nextBox2DTask + 1) % Box2DTaskCount;
+
+            slot.task = task;
+            slot.context = taskContext;
+            const UnsignedInt count = UnsignedInt(itemCount);
+            const UnsignedInt chunk = Math::max(UnsignedInt(minRange),
+                                                (count + pool.getThreadCount() - 1)/pool.getThreadCount());
+            for(UnsignedInt begin = 0; begin < count; begin += chunk) {
+                pool.submit(slot.group, runBox2DTask, &slot, begin, Math::min(begin + chunk, count));
+            }
+            return &slot;
+        }
+
+        static void finishBox2DTask(void *userTask, void *userContext) {
+            static_cast<WorkerPool*>(userContext)->wait(static_cast<Box2DTask*>(userTask)->group);
+        }
+
+    private:
+        static constexpr UnsignedInt MaxWorkers = 15;
+        // tasks Box2D may have unfinished at once, it finishes each one within its step stage
+        static constexpr UnsignedInt Box2DTaskCount = 64;
+
+        struct Task {
+            TaskFunction function;
+            void *context;
+            UnsignedInt begin, end;
+            TaskGroup *group;
+        };
+
+        struct Box2DTask {
+            b2TaskCallback *task;
+            void *context;
+            TaskGroup group;
+        };
+
+        static UnsignedInt &currentThreadIndex() {
+            thread_local UnsignedInt index = 0;
+            return index;
+        }
+
+        static void runBox2DTask(void *context, const UnsignedInt begin, const UnsignedInt end, const UnsignedInt thread) {
+            Trace::Scope scope{"b2Task"};
+            const Box2DTask &task = *static_cast<Box2DTask*>(context);
+            task.task(Int(begin), Int(end), thread, task.context);
+        }
+
+        bool pop(Task &task) {
+            if(_head == _queue.size()) return false;
+
+            task = _queue[_head++];
+            // everything taken, start over so the queue doesn't grow
+            if(_head == _queue.size()) {
+                Containers::arrayClear(_queue);
+                _head = 0;
+            }
+            return true;
+        }
+
+        bool runOne(const UnsignedInt thread) {
+            Task task;
+            {
+                std::lock_guard<std::mutex> lock{_mutex};
+                if(!pop(task)) return false;
+            }
+
+            task.function(task.context, task.begin, task.end, thread);
+            task.group->_pending.fetch_sub(1, std::memory_order_release);
+            return true;
+        }
+
+        void workerLoop(const UnsignedInt thread) {
+            // a track per worker in the trace, names have to be literals
+            static const char *const names[MaxWorkers]{
+                "Worker 1", "Worker 2", "Worker 3", "Worker 4", "Worker 5", "Worker 6", "Worker 7", "Worker 8",
+                "Worker 9", "Worker 10", "Worker 11", "Worker 12", "Worker 13", "Worker 14", "Worker 15"};
+            currentThreadIndex() = thread;
+            // registering a track allocates its event buffer, don't when not tracing
+            if(Trace::isEnabled()) Trace::setThreadName(names[thread - 1]);
+
+            for(;;) {
+                Task task;
+                {
+                    std::unique_lock<std::mutex> lock{_mutex};
+                    _wake.wait(lock, [this]{ return _stopping || _head != _queue.size(); });
+                    if(!pop(task)) return;
+                }
+
+                task.function(task.context, task.begin, task.end, thread);
+                task.group->_pending.fetch_sub(1, std::memory_order_release);
+            }
+        }
+
+        std::mutex _mutex;
+        std::condition_variable _wake;
+        Containers::Array<Task> _queue;
+        std::size_t _head = 0;
+        bool _stopping = false;
+
+        Box2DTask _box2DTasks[Box2DTaskCount]{};
+        UnsignedInt _nextBox2DTask = 0;
+
+        Containers::Array<std::thread> _threads;
+    };
+}
+
+#endif //MAGNUM_MOONLANDER_WORKERPOOL_H
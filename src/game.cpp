@@ -1,4 +1,9 @@
+#include <chrono>
+#include <utility>
+
+#include <Corrade/Containers/StringStl.h>
 #include <Corrade/Utility/Arguments.h>
+#include <Corrade/Utility/Path.h>
 
 #include <Magnum/GL/Context.h>
 #include <Magnum/GL/DefaultFramebuffer.h>
@@ -8,14 +13,35 @@
 #include <Magnum/Math/Time.h>
 #include <Magnum/Math/Distance.h>
 
-#include <Magnum/Shaders/Flat.h>
 #include <Magnum/Platform/Sdl2Application.h>
 #include <Magnum/Primitives/Square.h>
 
+#include <SDL_events.h>
+#include <SDL_keyboard.h>
+#include <SDL_timer.h>
+
 #include "MoonLander/Game.h"
 #include "MoonLander/Level.h"
 #include "MoonLander/CameraControl.h"
 #include "MoonLander/AssetManager.h"
+#include "MoonLander/AnimationSystem.h"
+#include "MoonLander/AllocationTracker.h"
+#include "MoonLander/Hud.h"
+#include "MoonLander/ShaderCache.h"
+#include "MoonLander/BackgroundLayer.h"
+#include "MoonLander/RedrawTracker.h"
+#include "MoonLander/LatencyTracker.h"
+#include "MoonLander/DebugDraw.h"
+#include "MoonLander/DebrisPool.h"
+#include "MoonLander/FloatingOrigin.h"
+#include "MoonLander/Rope.h"
+#include "MoonLander/RangeScanner.h"
+#include "MoonLander/LevelScripts.h"
+#include "MoonLander/Trace.h"
+#include "MoonLander/JobGraph.h"
+#include "MoonLander/WorkerPool.h"
+#include "MoonLander/PhysicsStepScheduler.h"
+#include "MoonLander/PhysicsLod.h"
 #include "MoonLander/Sprite.h"
 #include "MoonLander/SpriteAnimation.h"
 
@@ -27,6 +53,9 @@ namespace Magnum::Game {
     static void UpdateZoomByDistance(CameraControl& cameraControl, Vector2 p1, Vector2 p2);
 
     constexpr Float _engineForceStep = 1.0f;
+    // impact speed that breaks the lander apart
+    constexpr Float _crashSpeed = 4.0f;
+    constexpr Vector2 _landerStart{0.0f, 10.0f};
 
     Vector2 _previousPointerPosition = {0.0f, 0.0f};
     Float _previousVelocityMagnitude = 0.0f;
@@ -51,14 +80,35 @@ namespace Magnum::Game {
         void scrollEvent(ScrollEvent &event) override;
         void pointerPressEvent(PointerEvent& event) override;
 
+        void setupHud();
+        void setupJobs();
+        void updateHud(Float dt);
+        void sampleThrusters();
+        void checkCrash();
+        void resetLander();
+        void rebaseOrigin();
+        void toggleCargo();
+
         Scene2D _scene{};
         Timeline _timeline{};
 
+        // Chrome trace output, tracing is off if empty
+        std::string _traceFilename;
+
         AssetManager _asset;
+        AnimationSystem _animations{64};
+
+        AllocationTracker _allocations;
+        UnsignedInt _tickAllocationScope = _allocations.addScope("tickEvent");
+        UnsignedInt _drawAllocationScope = _allocations.addScope("drawEvent");
+        // frames left to record allocation callstacks for, see F10
+        Int _allocationCallstackFrames = 0;
 
         Optional<CameraControl> _cc;
 
-        Shaders::FlatGL2D _spriteShader{NoCreate};
+        // owns every shader variant, has to outlive the level and sprites
+        ShaderCache _shaders;
+        FlatShader *_spriteShader = nullptr;
 
         Containers::Pointer<Level> _level;
         Containers::Pointer<Lander> _lander;
@@ -74,11 +124,96 @@ namespace Magnum::Game {
 
         Containers::Pointer<SpriteAnimation> _engineEffectAnimation;
 
+        // sling load, C hooks the capsule up and lets go of it, see toggleCargo()
+        Rope::Configuration _ropeConfiguration;
+        Optional<Rope> _rope;
+        Containers::Pointer<Object2D> _capsuleObject;
+        Containers::Pointer<Object2D> _capsuleEffectObject;
+        Containers::Pointer<Sprite> _capsuleSprite;
+        Containers::Pointer<Sprite> _capsuleEffectSprite;
+        Containers::Pointer<SpriteAnimation> _capsuleEffectAnimation;
+
+        PhysicsStepScheduler _stepScheduler;
+        PhysicsLod _physicsLod;
+
+        // the tick after input handling, run on a pool shared with the Box2D solver, see setupJobs()
+        Optional<WorkerPool> _workers;
+        JobGraph _jobs;
+        Float _tickDt = 0.0f;
+
+        // on-demand rendering, draws only frames that changed, see F8
+        bool _onDemand = false;
+        RedrawTracker _redraw;
+        Optional<BackgroundLayer> _background;
+
+        // frame pacing, see the --pacing option
+        enum class Pacing: UnsignedByte {
+            // swap interval 1 and a fixed 16 ms minimal loop period
+            Fixed,
+            // no vsync, FramePacer sleeps as late as the predicted work allows
+            Adaptive,
+            // vsync, glFinish() after the swap so no frames queue up in the driver
+            VsyncFinish
+        };
+        Pacing _pacing = Pacing::Fixed;
+        // thrusters sampled from the keyboard state right before the step
+        bool _lowLatency = false;
+        FramePacer _pacer;
+        LatencyTracker _latency;
+
+        // collider overlay, F5 shows it and 1 to 7 toggle its categories
+        Optional<DebugDraw> _debugDraw;
+        bool _debugDrawEnabled = false;
+
+        // radar altimeter and ground scanner, for the HUD and an autopilot
+        RangeScanner _scanner;
+
+        // the lander breaks into pooled pieces on a hard impact, R brings it back
+        Optional<DebrisPool> _debris;
+        UnsignedInt _landerFracture = 0;
+        bool _crashed = false;
+
+        Containers::Pointer<Hud> _hud;
+        struct {
+            UnsignedInt altitude, velocityX, velocityY, speed, fuel, thrustX, thrustY, score, radar, clearance;
+            UnsignedInt frameTime, subSteps, stepTime, contacts, boxes, lodActive, lodSettling, lodFrozen, terrainSegments;
+        } _hudFields{};
+        UnsignedInt _rockCount = 0;
+
+        // shown on the HUD, awarded by the landedThenScore() script
+        UnsignedInt _score = 0;
+
+        // signals before the scheduler, suspended scripts are destroyed before what they wait on
+        ContactSignals _contactSignals;
+        // fired by resetLander()
+        Signal _landerReset;
+        ScriptScheduler _scripts;
+
         b2WorldId _worldId{};
         b2BodyId _landerBodyId{};
+        // null until the cargo is hooked up the first time
+        b2BodyId _capsuleBodyId{};
     };
 
     MoonLander::~MoonLander() {
+        if (!_traceFilename.empty()) {
+            Trace::write(_traceFilename);
+        }
+
+        if (AllocationTracker::isEnabled()) {
+            _allocations.print();
+        }
+
+        if (_onDemand) {
+            _redraw.print();
+        }
+
+        _latency.print("[latency] input to present");
+        _jobs.print();
+        if (_level) {
+            _level->getOrigin().print();
+        }
+
         // Clean up Box2D resources
         if (_level) {
             _level.reset(nullptr);
@@ -89,14 +224,81 @@ namespace Magnum::Game {
     }
 
     MoonLander::MoonLander(const Arguments &arguments) : Platform::Application{arguments, NoCreate} {
+        using Clock = std::chrono::steady_clock;
+        const Clock::time_point startupBegin = Clock::now();
+        const auto millisecondsSince = [](const Clock::time_point from) {
+            return std::chrono::duration<Double, std::milli>(Clock::now() - from).count();
+        };
+
         Utility::Arguments args;
+        args.addOption("trace", "")
+            .setHelp("trace", "record a Chrome trace of the game loop into this file, F9 writes it mid-game")
+            .addOption("physics-budget", "2.0")
+            .setHelp("physics-budget", "CPU budget of a world step in milliseconds, 0 keeps the substep count fixed")
+            .addOption("substeps-min", "2")
+            .setHelp("substeps-min", "fewest substeps per world step")
+            .addOption("substeps-max", "8")
+            .setHelp("substeps-max", "most substeps per world step")
+            .addBooleanOption("physics-verbose")
+            .setHelp("physics-verbose", "print substep count changes")
+            .addBooleanOption("on-demand")
+            .setHelp("on-demand", "draw only when something changed, F8 toggles it")
+            .addOption("texture-budget", "0")
+            .setHelp("texture-budget", "video memory budget of textures in bytes, 0 is unlimited")
+            .addBooleanOption("low-latency")
+            .setHelp("low-latency", "sample thrusters right before the step, implies --pacing adaptive")
+            .addOption("pacing", "")
+            .setHelp("pacing", "frame pacing, fixed, adaptive or vsync-finish", "MODE")
+            .addOption("frame-period", "16.667")
+            .setHelp("frame-period", "frame period adaptive pacing aims for in milliseconds")
+            .addOption("workers", "-1")
+            .setHelp("workers", "worker threads for the tick and the physics solver, -1 picks one per spare core")
+            .addOption("rope-segments", "100")
+            .setHelp("rope-segments", "segments of the cargo rope, C hooks the cargo up")
+            .addOption("shader-cache", "")
+            .setHelp("shader-cache", "directory for linked shader binaries, defaults to the configuration directory, none turns it off", "DIR")
+            .addSkippedPrefix("magnum", "engine-specific options")
+            .parse(arguments.argc, arguments.argv);
+
+        _traceFilename = args.value("trace");
+        _ropeConfiguration.segmentCount = UnsignedInt(Math::max(args.value<Int>("rope-segments"), 2));
+        _onDemand = args.isSet("on-demand");
+        _lowLatency = args.isSet("low-latency");
+        {
+            const std::string pacing = args.value("pacing");
+            if(pacing == "adaptive" || (pacing.empty() && _lowLatency)) {
+                _pacing = Pacing::Adaptive;
+            } else if(pacing == "vsync-finish") {
+                _pacing = Pacing::VsyncFinish;
+            } else if(!pacing.empty() && pacing != "fixed") {
+                Warning{} << "unknown pacing" << pacing << Debug::nospace << ", using fixed";
+            }
+
+            FramePacer::Configuration pacerConfiguration;
+            pacerConfiguration.periodMilliseconds = args.value<Double>("frame-period");
+            _pacer = FramePacer{pacerConfiguration};
+        }
+        if(!_traceFilename.empty()) {
+            Trace::setEnabled(true);
+        }
 
-        // TODO: add command options
-//        args.addOption("transformation", "1 0 0 0")
-//        .setHelp("transformation", "initial pyramid transformation")
-//        .addSkippedPrefix("magnum", "engine-specific options")
-//        .parse(arguments.argc, arguments.argv);
+        // after tracing is enabled so the workers get their own named tracks
+        {
+            WorkerPool::Configuration workerConfiguration;
+            if(const Int workers = args.value<Int>("workers"); workers >= 0) {
+                workerConfiguration.workerCount = UnsignedInt(workers);
+            }
+            _workers.emplace(workerConfiguration);
+        }
 
+        {
+            PhysicsStepScheduler::Configuration stepConfiguration;
+            stepConfiguration.budgetMilliseconds = args.value<Double>("physics-budget");
+            stepConfiguration.minSubSteps = args.value<Int>("substeps-min");
+            stepConfiguration.maxSubSteps = args.value<Int>("substeps-max");
+            stepConfiguration.verbose = args.isSet("physics-verbose");
+            _stepScheduler = PhysicsStepScheduler{stepConfiguration};
+        }
 
         /*
          * try 8x MSAA, fall back to zero samples if not possible.
@@ -112,30 +314,64 @@ namespace Magnum::Game {
             if (!tryCreate(conf, glConf))
                 create(conf, glConf.setSampleCount(0));
         }
+        const Double contextMilliseconds = millisecondsSince(startupBegin);
 
         // setup renderer
         GL::Renderer::enable(GL::Renderer::Feature::Blending);
         GL::Renderer::setBlendFunction(GL::Renderer::BlendFunction::One,
                                        GL::Renderer::BlendFunction::OneMinusSourceAlpha);
 
-        _spriteShader = Shaders::FlatGL2D {Shaders::FlatGL2D::Configuration{}
-            .setFlags(Shaders::FlatGL2D::Flag::Textured
-                | Shaders::FlatGL2D::Flag::TextureTransformation)};
+        // linked programs from earlier runs are loaded instead of compiled
+        {
+            std::string shaderCache = args.value("shader-cache");
+            if(shaderCache.empty()) {
+                if(const Optional<Containers::String> configuration =
+                    Utility::Path::configurationDirectory("MoonLander")) {
+                    shaderCache = Utility::Path::join(*configuration, "shaders");
+                }
+            }
+            if(shaderCache != "none") _shaders.setBinaryDirectory(shaderCache);
+        }
+
+        // submit all variants at once so the driver can link them in parallel
+        {
+            Trace::Scope shaderScope{"ShaderCache::precompile"};
+            const ShaderCache::Flags spriteFlags = FlatShader::Flag::Textured
+                | FlatShader::Flag::TextureTransformation;
+            _shaders.precompile({{}, spriteFlags, InstancedShapes::ShaderFlags, DebugDraw::ShaderFlags,
+                                 DebrisPool::ShaderFlags});
+            _spriteShader = &_shaders.flat(spriteFlags);
+        }
 
         // load image textures
-        _asset.addTexture("Lander", "Lander.png");
-        _asset.addTexture("LanderEngineEffect", "LanderEngineEffect.png");
+        const Clock::time_point texturesBegin = Clock::now();
+        _asset.setBudget(args.value<std::size_t>("texture-budget"));
+        const TextureHandle landerTextureHandle = _asset.addTexture(Assets::Lander);
+        const TextureHandle engineEffectTextureHandle = _asset.addTexture(Assets::LanderEngineEffect);
+        const TextureHandle capsuleTextureHandle = _asset.addTexture(Assets::Capsule);
+        const TextureHandle capsuleEffectTextureHandle = _asset.addTexture(Assets::CapsuleEffect);
+        // sprites keep references to these
+        _asset.pin(landerTextureHandle);
+        _asset.pin(engineEffectTextureHandle);
+        _asset.pin(capsuleTextureHandle);
+        _asset.pin(capsuleEffectTextureHandle);
+        const Double texturesMilliseconds = millisecondsSince(texturesBegin);
 
         // setup camera control
         _cc.emplace(CameraControl{new Object2D{&_scene}});
 
         // create box2d world with gravity vector
+        AllocationTracker::installBox2DAllocator();
         auto worldDef = b2DefaultWorldDef();
         worldDef.gravity = GravityConstant::Moon;
+        worldDef.workerCount = Int(_workers->getThreadCount());
+        worldDef.enqueueTask = WorkerPool::enqueueBox2DTask;
+        worldDef.finishTask = WorkerPool::finishBox2DTask;
+        worldDef.userTaskContext = &*_workers;
         _worldId = b2CreateWorld(&worldDef);
 
         // create and initialize level
-        _level.emplace(_scene, _worldId);
+        _level.emplace(_scene, _worldId, _shaders);
         _level->initialize();
 
         // create mesh for sprites
@@ -143,8 +379,8 @@ namespace Magnum::Game {
         _engineEffectSpriteMesh = MeshTools::compile(squareSolid(Primitives::SquareFlag::TextureCoordinates));
 
         {
-            auto landerTexture = _asset.getTexture("Lander");
-            auto engineEffectTexture = _asset.getTexture("LanderEngineEffect");
+            GL::Texture2D &landerTexture = _asset.getTexture(landerTextureHandle);
+            GL::Texture2D &engineEffectTexture = _asset.getTexture(engineEffectTextureHandle);
 
             Vector2 landerScale = {
                 20.f * _cc->getCamera().projectionMatrix().scaling().sum(),
@@ -156,7 +392,7 @@ namespace Magnum::Game {
                 8.f * _cc->getCamera().projectionMatrix().scaling().sum(),
             };
 
-            auto transformation = DualComplex::translation(Vector2::yAxis(10.0f));
+            auto transformation = DualComplex::translation(_landerStart);
 
             // lander
             _landerObject.emplace(&_scene);
@@ -168,38 +404,367 @@ namespace Magnum::Game {
                 transformation,
                 landerScale,
                 b2_dynamicBody,
-                2.0
+                2.0,
+                CollisionFilter::lander()
                 );
 
-            _landerSprite.emplace(_spriteShader, *landerTexture, _landerSpriteMesh, Vector2i{20, 20});
+            _landerSprite.emplace(*_spriteShader, landerTexture, _landerSpriteMesh, Vector2i{20, 20});
 
             // engine effect
             _engineEffectObject.emplace(_landerObject.get());
             _engineEffectObject->translateLocal({0, -1.5});
             _engineEffectObject->setScaling(engineEffectScale);
 
-            _engineEffectSprite.emplace(_spriteShader, *engineEffectTexture, _engineEffectSpriteMesh, Vector2i{8, 8});
-            _engineEffectAnimation.emplace(*_engineEffectSprite, 0.1f);
+            _engineEffectSprite.emplace(*_spriteShader, engineEffectTexture, _engineEffectSpriteMesh, Vector2i{8, 8});
+            _engineEffectAnimation.emplace(_animations, *_engineEffectSprite, 0.1f);
 
             // lander
             _lander.emplace(*_landerObject, *_landerSprite, *_engineEffectSprite, *_engineEffectAnimation);
+
+            // all pieces exist from the start, a crash only enables them
+            _debris.emplace(_shaders, _worldId);
+            _landerFracture = _debris->addTemplate(LanderFracture, landerScale, b2Body_GetMass(_landerBodyId),
+                                                   landerTexture);
+
+            // cargo capsule, same pixel size as the lander, the body is only created once it's hooked up
+            const Vector2 pixelSize = landerScale/20.0f;
+            _capsuleObject.emplace(&_scene);
+            _capsuleObject->setScaling(pixelSize*Vector2{7.0f, 5.0f});
+            _capsuleSprite.emplace(*_spriteShader, _asset.getTexture(capsuleTextureHandle), _landerSpriteMesh,
+                                   Vector2i{14, 10});
+
+            // beacon under it while it's in tow, the sprite meshes are all the same square
+            _capsuleEffectObject.emplace(_capsuleObject.get());
+            _capsuleEffectObject->translateLocal({0, -2.5f});
+            _capsuleEffectObject->setScaling(Vector2{9.0f}/Vector2{7.0f, 5.0f});
+            _capsuleEffectSprite.emplace(*_spriteShader, _asset.getTexture(capsuleEffectTextureHandle),
+                                         _landerSpriteMesh, Vector2i{18, 18});
+            _capsuleEffectAnimation.emplace(_animations, *_capsuleEffectSprite, 0.15f);
         }
 
         _engineEffectAnimation->start();
 
-        setSwapInterval(1);
+        setupHud();
+        setupJobs();
+
+        _scripts.start(landedThenScore(
+            _contactSignals.between(_landerBodyId, _level->getLandingPad().getBodyId()), _landerReset,
+            _landerBodyId, *_lander, _score));
+
+        // static geometry is cached in a texture, it's only worth it when frames get skipped
+        _background.emplace(_shaders, framebufferSize());
+        _debugDraw.emplace(_shaders);
+
+        // compare a first run with a later one to see the driver's shader cache at work
+        _shaders.print();
+        _asset.print();
+        Debug{} << "[startup] context" << contextMilliseconds << "ms, shaders" << _shaders.getCompileMilliseconds()
+            << "ms, textures" << texturesMilliseconds << "ms, total" << millisecondsSince(startupBegin) << "ms";
+
+        // adaptive pacing does the waiting itself, right before the input is sampled
+        setSwapInterval(_pacing == Pacing::Adaptive ? 0 : 1);
 #if !defined(CORRADE_TARGET_EMSCRIPTEN) && !defined(CORRADE_TARGET_ANDROID)
-        setMinimalLoopPeriod(16.0_msec);
+        if(_pacing == Pacing::Fixed) {
+            setMinimalLoopPeriod(16.0_msec);
+        }
 #endif
         _timeline.start();
     }
 
+    void MoonLander::setupHud() {
+        _hud.emplace(_shaders, framebufferSize());
+
+        // flight telemetry on the left, simulation diagnostics next to it
+        _hudFields.altitude = _hud->addField("ALT", 0, 0, 8, 1);
+        _hudFields.velocityX = _hud->addField("VX ", 1, 0, 8, 2);
+        _hudFields.velocityY = _hud->addField("VY ", 2, 0, 8, 2);
+        _hudFields.speed = _hud->addField("SPD", 3, 0, 8, 2);
+        _hudFields.fuel = _hud->addField("FUEL", 4, 0, 7, 1);
+        _hudFields.thrustX = _hud->addField("TX ", 5, 0, 8, 1);
+        _hudFields.thrustY = _hud->addField("TY ", 6, 0, 8, 1);
+        _hudFields.score = _hud->addField("SCORE", 7, 0, 6, 0);
+        _hudFields.radar = _hud->addField("RADAR", 8, 0, 6, 1);
+        _hudFields.clearance = _hud->addField("CLEAR", 9, 0, 6, 1);
+
+        _hudFields.frameTime = _hud->addField("FRAME MS", 0, 16, 6, 1);
+        _hudFields.subSteps = _hud->addField("SUBSTEPS", 1, 16, 6, 0);
+        _hudFields.stepTime = _hud->addField("STEP MS ", 2, 16, 6, 2);
+        _hudFields.contacts = _hud->addField("CONTACTS", 3, 16, 6, 0);
+        _hudFields.boxes = _hud->addField("BOXES   ", 4, 16, 6, 0);
+        _hudFields.lodActive = _hud->addField("ACTIVE  ", 5, 16, 6, 0);
+        _hudFields.lodSettling = _hud->addField("SETTLING", 6, 16, 6, 0);
+        _hudFields.lodFrozen = _hud->addField("FROZEN  ", 7, 16, 6, 0);
+        _hudFields.terrainSegments = _hud->addField("REBUILDS", 8, 16, 6, 0);
+    }
+
+    /*
+     * Everything the tick does after the input is sampled. What a job reads
+     * and writes orders it after the jobs declared above it, the animation
+     * and camera jobs don't touch the world so they overlap with the step.
+     */
+    void MoonLander::setupJobs() {
+        const UnsignedInt world = _jobs.addResource("world");
+        const UnsignedInt terrain = _jobs.addResource("terrain");
+        const UnsignedInt boxes = _jobs.addResource("boxes");
+        const UnsignedInt boxObjects = _jobs.addResource("box objects");
+        const UnsignedInt lander = _jobs.addResource("lander");
+        const UnsignedInt animations = _jobs.addResource("animations");
+        const UnsignedInt physicsLod = _jobs.addResource("physics LOD");
+        const UnsignedInt stepScheduler = _jobs.addResource("step scheduler");
+        const UnsignedInt scanner = _jobs.addResource("scanner");
+        const UnsignedInt scripts = _jobs.addResource("scripts");
+        const UnsignedInt hud = _jobs.addResource("hud");
+        const UnsignedInt camera = _jobs.addResource("camera");
+        const UnsignedInt debris = _jobs.addResource("debris");
+        const UnsignedInt cargo = _jobs.addResource("cargo");
+
+        _jobs.addJob("b2World_Step", {}, {world, stepScheduler}, [this]{
+            _stepScheduler.step(_worldId, _tickDt);
+        });
+
+        _jobs.addJob("DebrisPool::update", {}, {world, debris}, [this]{
+            _debris->update(_tickDt);
+        });
+
+        // scripts may add boxes, which compiles meshes
+        _jobs.addJob("ScriptScheduler::update", {lander}, {world, boxes, scripts}, [this]{
+            _contactSignals.update(b2World_GetContactEvents(_worldId));
+            _scripts.update(_tickDt);
+        }, JobGraph::Affinity::MainThread);
+
+        _jobs.addJob("PhysicsLod::update", {boxes, camera}, {world, physicsLod}, [this]{
+            _physicsLod.update(_worldId, _cc->viewRectangle(), _level->getBoxes(), _level->getRockBodies());
+        });
+
+        _jobs.addJob("AnimationSystem::advance", {}, {animations}, [this]{
+            _redraw.checkAnimations(_animations.advance(_tickDt));
+        });
+
+        _jobs.addJob("Level::updateTerrain", {}, {world, terrain}, [this]{
+            _level->updateTerrain();
+        }, JobGraph::Affinity::MainThread);
+
+        // chunks of the transform sync spread over the workers
+        _jobs.addJob("Level::syncBoxes", {world, boxes}, {boxObjects}, [this]{
+            _workers->parallelFor(UnsignedInt(_level->getBoxes().size()), 256,
+                [this](const UnsignedInt begin, const UnsignedInt end, UnsignedInt) {
+                    Trace::Scope traceScope{"Level::syncBoxes chunk"};
+                    _level->syncBoxes(begin, end, _tickDt);
+                });
+        });
+
+        _jobs.addJob("Lander::update", {}, {world, lander, animations}, [this]{
+            if(_crashed) return;
+
+            if(_lowLatency) {
+                _lander->syncObject(_landerBodyId);
+            } else {
+                _lander->update(_tickDt, _landerBodyId);
+            }
+        });
+
+        // the strip is uploaded in drawEvent()
+        _jobs.addJob("Rope::update", {world}, {cargo}, [this]{
+            if(B2_IS_NULL(_capsuleBodyId)) return;
+
+            const b2Transform transform = b2Body_GetTransform(_capsuleBodyId);
+            _capsuleObject->setTranslation({transform.p.x, transform.p.y})
+                .setRotation(Complex::rotation(Rad{b2Rot_GetAngle(transform.q)}));
+            if(_rope) _rope->update();
+        });
+
+        _jobs.addJob("RangeScanner::scan", {world, terrain}, {scanner}, [this]{
+            _scanner.scan(_worldId, _landerBodyId, _level->getStaticRevision());
+        });
+
+        // pick the substep count of the next step
+        _jobs.addJob("PhysicsStepScheduler::update", {world}, {stepScheduler}, [this]{
+            _stepScheduler.update(
+                b2World_GetCounters(_worldId).contactCount,
+                PhysicsStepScheduler::touchingContactCount(_landerBodyId),
+                b2Length(b2Body_GetLinearVelocity(_landerBodyId)));
+        });
+
+        _jobs.addJob("Hud::layout", {world, terrain, boxes, lander, physicsLod, stepScheduler, scanner, scripts}, {hud},
+            [this]{ updateHud(_tickDt); });
+
+        _jobs.addJob("Hud::upload", {}, {hud}, [this]{
+            _hud->update();
+        }, JobGraph::Affinity::MainThread);
+
+        _jobs.addJob("CameraControl::updateProjection", {}, {camera}, [this]{
+            _cc->updateProjection();
+        });
+    }
+
+    /// Lays out the telemetry, uploading it is left to Hud::update() on the GL thread
+    void MoonLander::updateHud(const Float dt) {
+        Trace::Scope traceScope{"Hud::layout"};
+
+        const b2Vec2 position = b2Body_GetPosition(_landerBodyId);
+        const b2Vec2 velocity = b2Body_GetLinearVelocity(_landerBodyId);
+        const Vector2 thrust = _lander->getThrust();
+
+        _hud->setValue(_hudFields.altitude, position.y - _level->getTerrain().heightAt(position.x));
+        _hud->setValue(_hudFields.velocityX, velocity.x);
+        _hud->setValue(_hudFields.velocityY, velocity.y);
+        _hud->setValue(_hudFields.speed, b2Length(velocity));
+        _hud->setValue(_hudFields.fuel, _lander->getFuel());
+        _hud->setValue(_hudFields.thrustX, thrust.x());
+        _hud->setValue(_hudFields.thrustY, thrust.y());
+        _hud->setValue(_hudFields.score, _score);
+        _hud->setValue(_hudFields.radar, _scanner.getAltitude().distance);
+        _hud->setValue(_hudFields.clearance, _scanner.getClosestDistance());
+        _hud->setThrust(thrust);
+
+        _hud->setValue(_hudFields.frameTime, dt*1000.0f);
+        _hud->setValue(_hudFields.subSteps, _stepScheduler.subSteps());
+        _hud->setValue(_hudFields.stepTime, _stepScheduler.stepMilliseconds());
+        _hud->setValue(_hudFields.contacts, b2World_GetCounters(_worldId).contactCount);
+        _hud->setValue(_hudFields.boxes, Double(_level->getBoxes().size()));
+        _hud->setValue(_hudFields.lodActive, _physicsLod.count(PhysicsLod::State::Active));
+        _hud->setValue(_hudFields.lodSettling, _physicsLod.count(PhysicsLod::State::Settling));
+        _hud->setValue(_hudFields.lodFrozen, _physicsLod.count(PhysicsLod::State::Frozen));
+        _hud->setValue(_hudFields.terrainSegments, Double(_level->getTerrain().getRebuiltSegmentCount()));
+    }
+
+    /*
+     * Impacts faster than _crashSpeed break the lander into debris. The
+     * pieces take over its velocity, the body itself is disabled until
+     * resetLander().
+     */
+    void MoonLander::checkCrash() {
+        if(_crashed) return;
+
+        const b2ContactEvents events = b2World_GetContactEvents(_worldId);
+        for(Int i = 0; i != events.hitCount; ++i) {
+            const b2ContactHitEvent &hit = events.hitEvents[i];
+            if(hit.approachSpeed < _crashSpeed) continue;
+            if(!B2_ID_EQUALS(b2Shape_GetBody(hit.shapeIdA), _landerBodyId) &&
+               !B2_ID_EQUALS(b2Shape_GetBody(hit.shapeIdB), _landerBodyId)) continue;
+
+            Debug{} << "[crash] impact at" << hit.approachSpeed << "m/s, press R to try again";
+            _debris->spawn(_landerFracture, _landerBodyId);
+            // the rope would hang on a disabled body
+            if(_rope) toggleCargo();
+            b2Body_Disable(_landerBodyId);
+            _lander->setForce({});
+            _crashed = true;
+            _redraw.damage(RedrawTracker::Reason::Bodies);
+            return;
+        }
+    }
+
+    void MoonLander::resetLander() {
+        const Vector2 start = _level->getOrigin().toWorld(_landerStart);
+        b2Body_SetTransform(_landerBodyId, {start.x(), start.y()}, b2Rot_identity);
+        b2Body_Enable(_landerBodyId);
+        b2Body_SetLinearVelocity(_landerBodyId, b2Vec2_zero);
+        b2Body_SetAngularVelocity(_landerBodyId, 0.0f);
+        _lander->setFuel(100.0f);
+        _lander->syncObject(_landerBodyId);
+        _scanner.invalidate();
+        _crashed = false;
+        _landerReset.fire();
+    }
+
+    /*
+     * Keeps the lander near the world origin, where floats are precise.
+     * The level, the lander, its debris and the camera move back together
+     * between two steps, so nothing on screen changes.
+     */
+    void MoonLander::rebaseOrigin() {
+        const b2Vec2 position = b2Body_GetPosition(_landerBodyId);
+        const Vector2 shift = _level->getOrigin().recenter({position.x, position.y});
+        if(shift.isZero()) return;
+
+        Trace::Scope traceScope{"rebaseOrigin"};
+        const UnsignedLong begin = Trace::now();
+
+        std::size_t bodyCount = _level->shiftOrigin(shift);
+        shiftBody(_landerBodyId, shift);
+        _lander->syncObject(_landerBodyId);
+        bodyCount += 1 + _debris->shiftOrigin(shift);
+        if(B2_IS_NON_NULL(_capsuleBodyId)) {
+            shiftBody(_capsuleBodyId, shift);
+            _capsuleObject->translate(-shift);
+            ++bodyCount;
+        }
+        if(_rope) bodyCount += _rope->shiftOrigin(shift);
+        _cc->moveTo(_cc->getContainerTranslation() - shift);
+
+        _level->getOrigin().record(Double(Trace::now() - begin)/1.0e6, bodyCount);
+        _scanner.invalidate();
+        _redraw.damage(RedrawTracker::Reason::Bodies);
+    }
+
+    /*
+     * The first hook-up puts the capsule on the rope right under the
+     * lander, after that it stays where it was let go of and can be
+     * picked up again from within the rope's length.
+     */
+    void MoonLander::toggleCargo() {
+        if(_rope) {
+            _rope = Containers::NullOpt;
+            _capsuleEffectAnimation->pause();
+            Debug{} << "[cargo] let go";
+            return;
+        }
+
+        if(_crashed) return;
+
+        const Vector2 landerAnchor{0.0f, -_landerObject->scaling().y()};
+        const Vector2 capsuleAnchor{0.0f, _capsuleObject->scaling().y()};
+        const b2Vec2 hook = b2Body_GetWorldPoint(_landerBodyId, {landerAnchor.x(), landerAnchor.y()});
+
+        if(B2_IS_NULL(_capsuleBodyId)) {
+            const Vector2 position{hook.x, hook.y - _ropeConfiguration.length - capsuleAnchor.y()};
+            _capsuleBodyId = newWorldObjectBody(_worldId, _capsuleObject.get(), DualComplex::translation(position),
+                                                _capsuleObject->scaling(), b2_dynamicBody, 2.0f,
+                                                CollisionFilter::box());
+            _capsuleObject->setTranslation(position);
+            _scripts.start(cargoDelivered(
+                _contactSignals.between(_capsuleBodyId, _level->getLandingPad().getBodyId()),
+                _capsuleBodyId, _score));
+        } else if(b2Distance(hook, b2Body_GetWorldPoint(_capsuleBodyId, {capsuleAnchor.x(), capsuleAnchor.y()}))
+                  > _ropeConfiguration.length) {
+            Debug{} << "[cargo] too far away to hook up";
+            return;
+        }
+
+        _rope.emplace(_shaders, _worldId, _landerBodyId, landerAnchor, _capsuleBodyId, capsuleAnchor,
+                      _ropeConfiguration);
+        _capsuleEffectAnimation->start();
+        _redraw.damage(RedrawTracker::Reason::Bodies);
+        Debug{} << "[cargo] hooked up on" << _rope->getSegmentCount() << "segments";
+    }
+
+    void MoonLander::sampleThrusters() {
+        Trace::Scope traceScope{"sampleThrusters"};
+
+        // events that arrived during the wait, they're dispatched only next frame but count from now
+        SDL_PumpEvents();
+        SDL_Event events[16];
+        const int eventCount = SDL_PeepEvents(events, 16, SDL_PEEKEVENT, SDL_KEYDOWN, SDL_KEYUP);
+        for(int i = 0; i < eventCount; ++i) {
+            _latency.input(events[i].key.timestamp);
+        }
+
+        const Uint8 *keys = SDL_GetKeyboardState(nullptr);
+        const auto held = [keys](const SDL_Keycode key) {
+            return keys[SDL_GetScancodeFromKey(key)] ? _engineForceStep : 0.0f;
+        };
+        _lander->setForce({held(SDLK_d) - held(SDLK_a), held(SDLK_w) - held(SDLK_s)});
+    }
+
     void MoonLander::pointerMoveEvent(PointerMoveEvent &event) {
         // @todo: implement display of coords when pointer moves
     }
 
     void MoonLander::pointerPressEvent(PointerEvent &event)
     {
+        _redraw.damage(RedrawTracker::Reason::Input);
+
         if(event.isPrimary())
         {
             _previousPointerPosition = event.position();
@@ -214,6 +779,23 @@ namespace Magnum::Game {
                 const auto transformation = DualComplex::translation(position + _cc->getContainerTranslation());
                 _level->addBox(transformation);
             }
+
+            // drop a rock, cycling through a few shapes that share their meshes
+            if(event.pointer() & Pointer::MouseRight)
+            {
+                const auto position = _cc->projectedPosition(
+                    Vector2{event.position()},
+                    Vector2{windowSize()}
+                    );
+
+                static const BodyShape rocks[]{
+                    BodyShape::regularPolygon(5, 0.4f, 0.05f),
+                    BodyShape::regularPolygon(7, 0.3f),
+                    BodyShape::circle(0.25f),
+                };
+                const auto transformation = DualComplex::translation(position + _cc->getContainerTranslation());
+                _level->addRock(transformation, rocks[_rockCount++ % 3], 0x9a8f80_rgbf);
+            }
         }
 
         event.setAccepted(true);
@@ -224,10 +806,16 @@ namespace Magnum::Game {
      * @param event Application mouse scroll event.
      */
     void MoonLander::scrollEvent(ScrollEvent &event) {
+        _redraw.damage(RedrawTracker::Reason::Input);
         _cc->OnScrollEvent(event);
     }
 
     void MoonLander::keyPressEvent(KeyEvent &event) {
+        _redraw.damage(RedrawTracker::Reason::Input);
+        if(!event.isRepeated()) {
+            _latency.input(event.event().key.timestamp);
+        }
+
         // pass key event to camera control
         _cc->OnKeyPressEvent(event);
 
@@ -237,6 +825,71 @@ namespace Magnum::Game {
             exit();
         }
 
+        // write the trace recorded so far
+        if(event.key() == Key::F9) {
+            if(!_traceFilename.empty()) {
+                Trace::write(_traceFilename);
+            }
+            event.setAccepted(true);
+        }
+
+        // switch between on-demand and full-rate rendering
+        if(event.key() == Key::F8) {
+            _onDemand = !_onDemand;
+            Debug{} << "[redraw] on-demand rendering" << (_onDemand ? "on" : "off");
+            redraw();
+            event.setAccepted(true);
+        }
+
+        // collider overlay and its categories
+        if(event.key() == Key::F5) {
+            _debugDrawEnabled = !_debugDrawEnabled;
+            _redraw.damage(RedrawTracker::Reason::Layer);
+            event.setAccepted(true);
+        }
+
+        if(_debugDrawEnabled) {
+            constexpr std::pair<Key, DebugDraw::Category> categoryKeys[]{
+                {Key::One, DebugDraw::Category::Shapes},
+                {Key::Two, DebugDraw::Category::Joints},
+                {Key::Three, DebugDraw::Category::Bounds},
+                {Key::Four, DebugDraw::Category::Mass},
+                {Key::Five, DebugDraw::Category::Contacts},
+                {Key::Six, DebugDraw::Category::Impulses},
+                {Key::Seven, DebugDraw::Category::GraphColors},
+            };
+            for(const auto &[key, category]: categoryKeys) {
+                if(event.key() != key) continue;
+                _debugDraw->toggle(category);
+                _redraw.damage(RedrawTracker::Reason::Layer);
+                event.setAccepted(true);
+            }
+        }
+
+        // new lander after a crash
+        if(event.key() == Key::R) {
+            if(_crashed) resetLander();
+            event.setAccepted(true);
+        }
+
+        // hook up the cargo capsule or let go of it
+        if(event.key() == Key::C) {
+            toggleCargo();
+            event.setAccepted(true);
+        }
+
+        // a scripted wave of boxes
+        if(event.key() == Key::B) {
+            _scripts.start(boxWaves(*_level, 3, 8, 2.0));
+            event.setAccepted(true);
+        }
+
+        // record callstacks of allocations done in the next frame
+        if(event.key() == Key::F10) {
+            _allocationCallstackFrames = 2;
+            event.setAccepted(true);
+        }
+
         // forward
         if(event.key() == Key::W) {
             _lander->addForceY(_engineForceStep);
@@ -268,6 +921,9 @@ namespace Magnum::Game {
     }
 
     void MoonLander::keyReleaseEvent(KeyEvent &event) {
+        _redraw.damage(RedrawTracker::Reason::Input);
+        _latency.input(event.event().key.timestamp);
+
         if(event.key() == Key::W) {
             _lander->resetForceY();
             event.setAccepted(true);
@@ -295,47 +951,147 @@ namespace Magnum::Game {
     }
 
     void MoonLander::drawEvent() {
+        Trace::Scope traceScope{"drawEvent"};
+        AllocationTracker::Scope allocationScope{_allocations, _drawAllocationScope};
+
         GL::defaultFramebuffer.clear(GL::FramebufferClear::Color);
 
-        _level->draw(_cc->getCamera());
+        {
+            Trace::Scope levelScope{"Level::draw"};
+            if(_onDemand) {
+                _background->update(_cc->getCamera(), _level->getStaticRevision(),
+                    [this](SceneGraph::Camera2D &camera) { _level->drawStatic(camera); },
+                    GL::defaultFramebuffer);
+                _background->draw();
+                _level->drawDynamic(_cc->getCamera());
+            } else {
+                _level->draw(_cc->getCamera());
+            }
+        }
+
+        if(!_crashed) {
+            Trace::Scope spriteScope{"Sprite::draw"};
 
-        _landerSprite->draw(
-                _cc->getCamera().projectionMatrix(),
-                _landerObject->transformationMatrix()
-                );
+            _landerSprite->draw(
+                    _cc->getCamera().projectionMatrix()*_cc->getCamera().cameraMatrix(),
+                    _landerObject->transformationMatrix()
+                    );
 
-        _engineEffectSprite->draw(
-                _cc->getCamera().projectionMatrix(),
-                _engineEffectObject->absoluteTransformationMatrix()
-                );
+            _engineEffectSprite->draw(
+                    _cc->getCamera().projectionMatrix()*_cc->getCamera().cameraMatrix(),
+                    _engineEffectObject->absoluteTransformationMatrix()
+                    );
+        }
+
+        {
+            SceneGraph::Camera2D &camera = _cc->getCamera();
+            _debris->draw(camera.projectionMatrix()*camera.cameraMatrix());
+        }
+
+        if(B2_IS_NON_NULL(_capsuleBodyId)) {
+            Trace::Scope cargoScope{"Rope::draw"};
+            SceneGraph::Camera2D &camera = _cc->getCamera();
+            const Matrix3 transformationProjection = camera.projectionMatrix()*camera.cameraMatrix();
+            if(_rope) _rope->draw(transformationProjection);
 
-        swapBuffers();
-        redraw();
+            _capsuleSprite->draw(transformationProjection, _capsuleObject->transformationMatrix());
+            if(_rope) {
+                _capsuleEffectSprite->draw(transformationProjection,
+                                           _capsuleEffectObject->absoluteTransformationMatrix());
+            }
+        }
+
+        if(_debugDrawEnabled) {
+            SceneGraph::Camera2D &camera = _cc->getCamera();
+            const Range2D view = _cc->viewRectangle();
+            _debugDraw->draw(_worldId, view, camera.projectionMatrix()*camera.cameraMatrix(),
+                             view.sizeX()/Float(framebufferSize().x()));
+        }
+
+        {
+            Trace::Scope hudScope{"Hud::draw"};
+            _hud->draw();
+        }
+
+        {
+            Trace::Scope swapScope{"swapBuffers"};
+            swapBuffers();
+        }
+
+        // block until the frame is actually out instead of queueing the next one behind it
+        if(_pacing == Pacing::VsyncFinish) {
+            Trace::Scope finishScope{"GL::Renderer::finish"};
+            GL::Renderer::finish();
+        }
+        _latency.presented(SDL_GetTicks());
+        if(_pacing == Pacing::Adaptive) {
+            _pacer.frameDone();
+        }
+
+        // on-demand frames are requested from tickEvent()
+        if(!_onDemand) {
+            redraw();
+        }
     }
 
     void MoonLander::tickEvent()
     {
-        _timeline.nextFrame();
-        const auto dt = _timeline.previousFrameDuration();
+        // a frame is a tick followed by a draw, fold the previous one
+        _allocations.endFrame();
+        if(_allocationCallstackFrames > 0) {
+            --_allocationCallstackFrames;
+            AllocationTracker::setCallstackCapture(_allocationCallstackFrames != 0);
+            if(_allocationCallstackFrames == 0) {
+                const std::size_t callstacks = AllocationTracker::printCallstacks();
+                Debug{} << "[allocations]" << callstacks << "callstacks recorded";
+            }
+        }
+
+        Trace::Scope traceScope{"tickEvent"};
+        // jobs of the tick allocate on the worker threads as well
+        AllocationTracker::Scope allocationScope{_allocations, _tickAllocationScope, AllocationTracker::Threads::All};
 
-        // step the world and update all object positions
-        b2World_Step(_worldId, dt, 6);
+        if(_pacing == Pacing::Adaptive) {
+            _pacer.wait();
+        }
 
-        _engineEffectAnimation->tick();
+        _timeline.nextFrame();
+        const auto dt = _timeline.previousFrameDuration();
 
-        _level->update(dt);
+        // input from here on is applied by this step
+        if(_lowLatency) {
+            sampleThrusters();
+            _latency.consumed();
 
-        if(_lander) {
-            _lander->update(dt, _landerBodyId);
+            Trace::Scope landerScope{"Lander::applyThrust"};
+            _lander->applyThrust(dt, _landerBodyId);
+        } else {
+            // the thrust set by the key handlers gets applied after this step, so it's felt one step later
+            _latency.consumed();
         }
 
+        // step the world, scripts, object positions, HUD and camera, see setupJobs()
+        _tickDt = dt;
+        _jobs.run(*_workers);
+        checkCrash();
+        rebaseOrigin();
+
         // move camera to lander position
         // const auto [landerX, landerY] = b2Body_GetPosition(_landerBodyId);
         // const auto landerPosition = Vector2{landerX, landerY};
         // _cc->moveTo(landerPosition);
 
-        // update
-        _cc->updateProjection();
+        if(_onDemand) {
+            // bodies moving, the camera and held thrusters keep it at full rate during play
+            _redraw.checkBodies(_worldId);
+            _redraw.checkCamera(_cc->getCamera());
+            if(!_lander->getThrust().isZero()) {
+                _redraw.damage(RedrawTracker::Reason::Input);
+            }
+            if(_redraw.consume()) {
+                redraw();
+            }
+        }
 
         // const Vector2 shipPosition = _lander->getObject().translation();
         // const Vector2 screenCenter = Vector2{windowSize()} / 2.0f;
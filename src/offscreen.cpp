@@ -0,0 +1,1141 @@
+#include <chrono>
+#include <format>
+
+#include <Corrade/Containers/StridedArrayView.h>
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/Utility/Arguments.h>
+#include <Corrade/Utility/Path.h>
+
+#include <Magnum/Image.h>
+#include <Magnum/ImageView.h>
+#include <Magnum/PixelFormat.h>
+
+#include <Magnum/GL/Context.h>
+#include <Magnum/GL/DefaultFramebuffer.h>
+#include <Magnum/GL/Framebuffer.h>
+#include <Magnum/GL/Renderbuffer.h>
+#include <Magnum/GL/RenderbufferFormat.h>
+#include <Magnum/GL/Renderer.h>
+
+#include <Magnum/Math/Color.h>
+#include <Magnum/Math/ConfigurationValue.h>
+
+#include <Magnum/Platform/WindowlessEglApplication.h>
+// CameraControl handles Sdl2Application input events
+#include <Magnum/Platform/Sdl2Application.h>
+#include <Magnum/Primitives/Square.h>
+#include <Magnum/Trade/AbstractImageConverter.h>
+
+#include "MoonLander/Game.h"
+#include "MoonLander/Level.h"
+#include "MoonLander/CameraControl.h"
+#include "MoonLander/AssetManager.h"
+#include "MoonLander/AnimationSystem.h"
+#include "MoonLander/AllocationTracker.h"
+#include "MoonLander/Trace.h"
+#include "MoonLander/PhysicsStepScheduler.h"
+#include "MoonLander/PhysicsLod.h"
+#include "MoonLander/FrameStatistics.h"
+#include "MoonLander/Hud.h"
+#include "MoonLander/ShaderCache.h"
+#include "MoonLander/BackgroundLayer.h"
+#include "MoonLander/RedrawTracker.h"
+#include "MoonLander/DebugDraw.h"
+#include "MoonLander/RangeScanner.h"
+#include "MoonLander/Script.h"
+#include "MoonLander/DebrisPool.h"
+#include "MoonLander/FloatingOrigin.h"
+#include "MoonLander/Rope.h"
+#include "MoonLander/JobGraph.h"
+#include "MoonLander/WorkerPool.h"
+#include "MoonLander/Sprite.h"
+#include "MoonLander/SpriteAnimation.h"
+
+namespace Magnum::Game {
+    using namespace Math::Literals;
+
+    static Double millisecondsBetween(const std::chrono::steady_clock::time_point from,
+                                      const std::chrono::steady_clock::time_point to) {
+        return std::chrono::duration<Double, std::milli>(to - from).count();
+    }
+
+    /**
+     * Windowless counterpart of the MoonLander application, meant for
+     * GPU-less machines (Mesa llvmpipe). It builds the same Level + lander
+     * scene, steps it with a fixed time step, renders each frame into an
+     * offscreen framebuffer and reports frame-time statistics. Selected
+     * frames are compared against (or saved as) golden images.
+     */
+    class MoonLanderOffscreen final : public Platform::WindowlessApplication {
+    public:
+        ~MoonLanderOffscreen();
+        explicit MoonLanderOffscreen(const Arguments &arguments);
+
+        int exec() override;
+
+    private:
+        void setupJobs();
+        void tick(Float dt);
+        void draw();
+        std::size_t shiftOrigin(const Vector2 &shift);
+
+        bool checkGolden(Int frame);
+        bool checkSteadyStateAllocations(Int frames);
+        void printWorldCounters(const char *label) const;
+        void benchmarkCraters(Int count);
+        void benchmarkScanner(Int count);
+        void churnTextures(Int count);
+        void benchmarkScripts(Int count);
+        void benchmarkCrashes(Int count);
+        void benchmarkOriginShifts(Int count);
+        void benchmarkRopes(Int ticks);
+
+        Utility::Arguments _args;
+
+        Vector2i _size;
+        Float _timeStep;
+
+        GL::Renderbuffer _color{NoCreate};
+        GL::Framebuffer _framebuffer{NoCreate};
+
+        PluginManager::Manager<Trade::AbstractImporter> _importerManager;
+        PluginManager::Manager<Trade::AbstractImageConverter> _converterManager;
+
+        Scene2D _scene{};
+
+        AssetManager _asset;
+        Optional<AnimationSystem> _animations;
+
+        AllocationTracker _allocations;
+        UnsignedInt _tickAllocationScope = _allocations.addScope("tick");
+        UnsignedInt _drawAllocationScope = _allocations.addScope("draw");
+
+        Optional<CameraControl> _cc;
+
+        // owns every shader variant, has to outlive the level and sprites
+        ShaderCache _shaders;
+        FlatShader *_spriteShader = nullptr;
+
+        Containers::Pointer<Level> _level;
+        Containers::Pointer<Lander> _lander;
+
+        Containers::Pointer<Object2D> _landerObject;
+        Containers::Pointer<Object2D> _engineEffectObject;
+
+        Containers::Pointer<Sprite> _landerSprite;
+        Containers::Pointer<Sprite> _engineEffectSprite;
+
+        GL::Mesh _landerSpriteMesh{NoCreate};
+        GL::Mesh _engineEffectSpriteMesh{NoCreate};
+
+        Containers::Pointer<SpriteAnimation> _engineEffectAnimation;
+
+        PhysicsStepScheduler _stepScheduler;
+        Optional<PhysicsLod> _physicsLod;
+        Optional<Hud> _hud;
+
+        // the tick as a job graph, on the same pool as the Box2D solver
+        Optional<WorkerPool> _workers;
+        JobGraph _jobs;
+        Float _tickDt = 0.0f;
+
+        // set with --on-demand
+        Optional<RedrawTracker> _redraw;
+        Optional<BackgroundLayer> _background;
+
+        // set with --scan-rays
+        Optional<RangeScanner> _scanner;
+
+        // set with --debug-draw
+        Optional<DebugDraw> _debugDraw;
+        FrameStatistics _debugDrawStatistics;
+
+        b2WorldId _worldId{};
+        b2BodyId _landerBodyId{};
+    };
+
+    MoonLanderOffscreen::~MoonLanderOffscreen() {
+        if (_level) {
+            _level.reset(nullptr);
+        }
+
+        b2DestroyWorld(_worldId);
+    }
+
+    MoonLanderOffscreen::MoonLanderOffscreen(const Arguments &arguments) : Platform::WindowlessApplication{arguments} {
+        _args.addOption("frames", "600").setHelp("frames", "number of frames to simulate and render")
+            .addOption("size", "800 600").setHelp("size", "offscreen framebuffer size")
+            .addOption("time-step", "0.0166667").setHelp("time-step", "fixed simulation time step in seconds")
+            .addOption("boxes", "0").setHelp("boxes", "number of extra boxes dropped into the level")
+            .addOption("debris", "0").setHelp("debris", "number of debris pieces, they don't collide with each other")
+            .addOption("rocks", "0").setHelp("rocks", "number of instanced rocks in four shared shapes")
+            .addOption("static-boxes", "0").setHelp("static-boxes", "number of unit static boxes stacked into platforms")
+            .addBooleanOption("bake-static").setHelp("bake-static",
+                "merge the static boxes into compound bodies half way through the run")
+            .addOption("animations", "0").setHelp("animations", "number of extra animation tracks advanced every tick")
+            .addOption("golden-dir", "").setHelp("golden-dir", "directory with golden images, comparison is skipped if empty")
+            .addOption("golden-interval", "0").setHelp("golden-interval", "check every N-th frame in addition to the last one")
+            .addOption("max-delta", "8").setHelp("max-delta", "maximum allowed per-channel difference")
+            .addOption("mean-delta", "0.5").setHelp("mean-delta", "maximum allowed mean per-channel difference")
+            .addBooleanOption("save-golden").setHelp("save-golden", "write golden images instead of comparing")
+            .addOption("zero-allocation-ticks", "0").setHelp("zero-allocation-ticks",
+                "after rendering, fail if any of this many further simulation ticks allocates")
+            .addOption("trace", "").setHelp("trace", "write a Chrome trace of the run into this file")
+            .addBooleanOption("physics-lod").setHelp("physics-lod", "let boxes and rocks far from the view settle and freeze them")
+            .addOption("physics-budget", "0").setHelp("physics-budget",
+                "CPU budget of a world step in milliseconds, 0 keeps 6 substeps so frames are reproducible")
+            .addOption("hud-fields", "0").setHelp("hud-fields", "draw a HUD with this many telemetry fields updated every tick")
+            .addBooleanOption("on-demand").setHelp("on-demand",
+                "draw only frames where something changed, static geometry is cached in a texture")
+            .addBooleanOption("debug-draw").setHelp("debug-draw",
+                "draw the Box2D debug overlay every frame and report its cost, use with --debris for a large scene")
+            .addOption("shader-cache", "").setHelp("shader-cache",
+                "keep linked shader binaries in this directory, a second run starts warm")
+            .addOption("texture-budget", "0").setHelp("texture-budget",
+                "video memory budget of textures in bytes, 0 is unlimited")
+            .addOption("texture-churn", "0").setHelp("texture-churn",
+                "after rendering, request the other sprite textures round-robin this many times under the budget")
+            .addOption("scripts", "0").setHelp("scripts",
+                "after rendering, suspend this many scripts and report the per-tick scheduler cost")
+            .addOption("crash-benchmark", "0").setHelp("crash-benchmark",
+                "after rendering, break this many objects apart and report the worst crash frames, pooled and not")
+            .addOption("origin-shifts", "0").setHelp("origin-shifts",
+                "after rendering, shift the world origin back and forth this many times and report the cost, use with --rocks 50000")
+            .addOption("rope-benchmark", "0").setHelp("rope-benchmark",
+                "after rendering, swing a cargo on ropes of 50 to 500 segments for this many ticks each and report the step time")
+            .addOption("workers", "0").setHelp("workers",
+                "worker threads for the tick and the physics solver, the job report shows what serializes it")
+            .addOption("scan-rays", "0").setHelp("scan-rays",
+                "scan the ground with this many rays every tick and report the cost of full scans")
+            .addOption("benchmark-craters", "0").setHelp("benchmark-craters",
+                "after rendering, carve this many craters and report the terrain rebuild cost")
+            .addSkippedPrefix("magnum", "engine-specific options")
+            .setGlobalHelp("Renders the MoonLander scene offscreen and reports frame-time statistics.")
+            .parse(arguments.argc, arguments.argv);
+
+        _size = _args.value<Vector2i>("size");
+        _timeStep = _args.value<Float>("time-step");
+
+        if(!_args.value("trace").empty()) {
+            Trace::setEnabled(true);
+        }
+
+        {
+            PhysicsStepScheduler::Configuration stepConfiguration;
+            stepConfiguration.budgetMilliseconds = _args.value<Double>("physics-budget");
+            _stepScheduler = PhysicsStepScheduler{stepConfiguration};
+        }
+
+        if(_args.isSet("physics-lod")) {
+            _physicsLod.emplace();
+        }
+
+        // extra tracks only load the animation system, they aren't drawn
+        const Int animations = _args.value<Int>("animations");
+        _animations.emplace(std::size_t(64 + animations));
+        for(Int i = 0; i != animations; ++i) {
+            const UnsignedInt id = _animations->add(8, 0.05f + 0.01f*Float(i % 8));
+            _animations->play(id);
+        }
+
+        Debug{} << "Renderer:" << GL::Context::current().rendererString()
+            << "by" << GL::Context::current().vendorString();
+
+        const auto setupBegin = std::chrono::steady_clock::now();
+
+        // offscreen render target
+        _color = GL::Renderbuffer{};
+        _color.setStorage(GL::RenderbufferFormat::RGBA8, _size);
+        _framebuffer = GL::Framebuffer{{{}, _size}};
+        _framebuffer.attachRenderbuffer(GL::Framebuffer::ColorAttachment{0}, _color);
+        CORRADE_INTERNAL_ASSERT(
+            _framebuffer.checkStatus(GL::FramebufferTarget::Draw) == GL::Framebuffer::Status::Complete);
+        _framebuffer.bind();
+
+        // setup renderer
+        GL::Renderer::enable(GL::Renderer::Feature::Blending);
+        GL::Renderer::setBlendFunction(GL::Renderer::BlendFunction::One,
+                                       GL::Renderer::BlendFunction::OneMinusSourceAlpha);
+
+        _shaders.setBinaryDirectory(_args.value("shader-cache"));
+
+        // submit all variants at once so the driver can link them in parallel
+        {
+            Trace::Scope shaderScope{"ShaderCache::precompile"};
+            const ShaderCache::Flags spriteFlags = FlatShader::Flag::Textured
+                | FlatShader::Flag::TextureTransformation;
+            _shaders.precompile({{}, spriteFlags, InstancedShapes::ShaderFlags, DebugDraw::ShaderFlags,
+                                 DebrisPool::ShaderFlags});
+            _spriteShader = &_shaders.flat(spriteFlags);
+        }
+
+        // load image textures
+        _asset.setBudget(_args.value<std::size_t>("texture-budget"));
+        const TextureHandle landerTextureHandle = _asset.addTexture(Assets::Lander);
+        const TextureHandle engineEffectTextureHandle = _asset.addTexture(Assets::LanderEngineEffect);
+        // sprites keep references to these
+        _asset.pin(landerTextureHandle);
+        _asset.pin(engineEffectTextureHandle);
+
+        // setup camera control, there is no default framebuffer to take the viewport from
+        _cc.emplace(CameraControl{new Object2D{&_scene}});
+        _cc->getCamera().setViewport(_size);
+        _cc->updateProjection();
+
+        // create box2d world with gravity vector
+        AllocationTracker::installBox2DAllocator();
+        auto worldDef = b2DefaultWorldDef();
+        worldDef.gravity = GravityConstant::Moon;
+        {
+            WorkerPool::Configuration workerConfiguration;
+            workerConfiguration.workerCount = UnsignedInt(Math::max(_args.value<Int>("workers"), 0));
+            _workers.emplace(workerConfiguration);
+        }
+        worldDef.workerCount = Int(_workers->getThreadCount());
+        worldDef.enqueueTask = WorkerPool::enqueueBox2DTask;
+        worldDef.finishTask = WorkerPool::finishBox2DTask;
+        worldDef.userTaskContext = &*_workers;
+        _worldId = b2CreateWorld(&worldDef);
+
+        // create and initialize level
+        _level.emplace(_scene, _worldId, _shaders);
+        _level->initialize();
+
+        // extra load, laid out on a fixed grid so runs are reproducible
+        const Int boxes = _args.value<Int>("boxes");
+        for(Int i = 0; i != boxes; ++i) {
+            const Vector2 position{-15.0f + Float(i % 30), 2.0f + Float(i / 30)*1.2f};
+            _level->addBox(DualComplex::translation(position));
+        }
+
+        const Int debris = _args.value<Int>("debris");
+        for(Int i = 0; i != debris; ++i) {
+            const Vector2 position{-15.0f + Float(i % 60)*0.5f, 4.0f + Float(i / 60)*0.5f};
+            _level->addDebris(DualComplex::translation(position));
+        }
+
+        const Int rocks = _args.value<Int>("rocks");
+        if(rocks > 0) {
+            const BodyShape shapes[]{
+                BodyShape::regularPolygon(5, 0.4f, 0.05f),
+                BodyShape::regularPolygon(7, 0.3f),
+                BodyShape::roundedBox({0.3f, 0.15f}, 0.08f),
+                BodyShape::circle(0.25f),
+            };
+            for(Int i = 0; i != rocks; ++i) {
+                const Vector2 position{-18.0f + Float(i % 72)*0.5f, 6.0f + Float(i / 72)*0.6f};
+                _level->addRock(DualComplex::translation(position), shapes[i % 4], 0x9a8f80_rgbf);
+            }
+        }
+
+        // two platforms built from unit boxes, a dense level before baking
+        const Int staticBoxes = _args.value<Int>("static-boxes");
+        for(Int i = 0; i != staticBoxes; ++i) {
+            const Int column = i % 24;
+            const Vector2 position{(column < 12 ? -16.5f : 4.5f) + Float(column % 12), -8.0f + Float(i / 24)};
+            _level->addStaticBox(DualComplex::translation(position), Vector2{0.5f}, 0x8090a0_rgbf);
+        }
+
+        // create mesh for sprites
+        _landerSpriteMesh = MeshTools::compile(squareSolid(Primitives::SquareFlag::TextureCoordinates));
+        _engineEffectSpriteMesh = MeshTools::compile(squareSolid(Primitives::SquareFlag::TextureCoordinates));
+
+        {
+            GL::Texture2D &landerTexture = _asset.getTexture(landerTextureHandle);
+            GL::Texture2D &engineEffectTexture = _asset.getTexture(engineEffectTextureHandle);
+
+            Vector2 landerScale = {
+                20.f * _cc->getCamera().projectionMatrix().scaling().sum(),
+                20.f * _cc->getCamera().projectionMatrix().scaling().sum(),
+            };
+
+            Vector2 engineEffectScale = {
+                8.f * _cc->getCamera().projectionMatrix().scaling().sum(),
+                8.f * _cc->getCamera().projectionMatrix().scaling().sum(),
+            };
+
+            auto transformation = DualComplex::translation(Vector2::yAxis(10.0f));
+
+            // lander
+            _landerObject.emplace(&_scene);
+            _landerObject->setScaling(landerScale);
+
+            _landerBodyId = newWorldObjectBody(
+                _worldId,
+                _landerObject.get(),
+                transformation,
+                landerScale,
+                b2_dynamicBody,
+                2.0,
+                CollisionFilter::lander()
+                );
+
+            _landerSprite.emplace(*_spriteShader, landerTexture, _landerSpriteMesh, Vector2i{20, 20});
+
+            // engine effect
+            _engineEffectObject.emplace(_landerObject.get());
+            _engineEffectObject->translateLocal({0, -1.5});
+            _engineEffectObject->setScaling(engineEffectScale);
+
+            _engineEffectSprite.emplace(*_spriteShader, engineEffectTexture, _engineEffectSpriteMesh, Vector2i{8, 8});
+            _engineEffectAnimation.emplace(*_animations, *_engineEffectSprite, 0.1f);
+
+            // lander
+            _lander.emplace(*_landerObject, *_landerSprite, *_engineEffectSprite, *_engineEffectAnimation);
+        }
+
+        _engineEffectAnimation->start();
+
+        // two columns of generic telemetry, field IDs are 0 to N-1
+        if(Int fields = _args.value<Int>("hud-fields"); fields > 0) {
+            // "FIELD", a space and eight digits
+            constexpr Int GlyphsPerField = 14;
+            const Int maxFields = Int(Hud::MaxGlyphCapacity)/GlyphsPerField;
+            if(fields > maxFields) {
+                Warning{} << "A HUD fits at most" << maxFields << "fields, drawing" << maxFields << "instead of" << fields;
+                fields = maxFields;
+            }
+
+            Hud::Configuration hudConfiguration;
+            hudConfiguration.glyphCapacity = UnsignedInt(fields*GlyphsPerField);
+            _hud.emplace(_shaders, _size, hudConfiguration);
+            for(Int i = 0; i != fields; ++i) {
+                _hud->addField("FIELD", i % 25, (i / 25)*16, 8, 2);
+            }
+        }
+
+        if(_args.isSet("on-demand")) {
+            _redraw.emplace();
+            _background.emplace(_shaders, _size);
+        }
+
+        if(_args.isSet("debug-draw")) {
+            _debugDraw.emplace(_shaders);
+        }
+
+        if(const Int rays = _args.value<Int>("scan-rays"); rays > 0) {
+            RangeScanner::Configuration scannerConfiguration;
+            scannerConfiguration.rayCount = UnsignedInt(rays);
+            _scanner.emplace(scannerConfiguration);
+        }
+
+        setupJobs();
+
+        // the context is created before this constructor runs, so it's not included
+        _shaders.print();
+        Debug{} << "[startup] shaders" << _shaders.getCompileMilliseconds() << "ms, setup"
+            << millisecondsBetween(setupBegin, std::chrono::steady_clock::now()) << "ms";
+    }
+
+    /*
+     * Same jobs as the game's tick, minus input and scripts. With no
+     * workers they run one after another on this thread.
+     */
+    void MoonLanderOffscreen::setupJobs() {
+        const UnsignedInt world = _jobs.addResource("world");
+        const UnsignedInt terrain = _jobs.addResource("terrain");
+        const UnsignedInt boxObjects = _jobs.addResource("box objects");
+        const UnsignedInt lander = _jobs.addResource("lander");
+        const UnsignedInt animations = _jobs.addResource("animations");
+        const UnsignedInt physicsLod = _jobs.addResource("physics LOD");
+        const UnsignedInt stepScheduler = _jobs.addResource("step scheduler");
+        const UnsignedInt scanner = _jobs.addResource("scanner");
+        const UnsignedInt hud = _jobs.addResource("hud");
+        const UnsignedInt camera = _jobs.addResource("camera");
+
+        _jobs.addJob("b2World_Step", {}, {world, stepScheduler}, [this]{
+            _stepScheduler.step(_worldId, _tickDt);
+        });
+
+        if(_physicsLod) {
+            _jobs.addJob("PhysicsLod::update", {camera}, {world, physicsLod}, [this]{
+                _physicsLod->update(_worldId, _cc->viewRectangle(), _level->getBoxes(), _level->getRockBodies());
+            });
+        }
+
+        _jobs.addJob("AnimationSystem::advance", {}, {animations}, [this]{
+            const std::size_t changedFrames = _animations->advance(_tickDt);
+            if(_redraw) {
+                _redraw->checkAnimations(changedFrames);
+            }
+        });
+
+        _jobs.addJob("Level::updateTerrain", {}, {world, terrain}, [this]{
+            _level->updateTerrain();
+        }, JobGraph::Affinity::MainThread);
+
+        _jobs.addJob("Level::syncBoxes", {world}, {boxObjects}, [this]{
+            _workers->parallelFor(UnsignedInt(_level->getBoxes().size()), 256,
+                [this](const UnsignedInt begin, const UnsignedInt end, UnsignedInt) {
+                    Trace::Scope traceScope{"Level::syncBoxes chunk"};
+                    _level->syncBoxes(begin, end, _tickDt);
+                });
+        });
+
+        _jobs.addJob("Lander::update", {}, {world, lander, animations}, [this]{
+            _lander->update(_tickDt, _landerBodyId);
+        });
+
+        if(_scanner) {
+            _jobs.addJob("RangeScanner::scan", {world, terrain}, {scanner}, [this]{
+                _scanner->scan(_worldId, _landerBodyId, _level->getStaticRevision());
+            });
+        }
+
+        _jobs.addJob("PhysicsStepScheduler::update", {world}, {stepScheduler}, [this]{
+            _stepScheduler.update(
+                b2World_GetCounters(_worldId).contactCount,
+                PhysicsStepScheduler::touchingContactCount(_landerBodyId),
+                b2Length(b2Body_GetLinearVelocity(_landerBodyId)));
+        });
+
+        if(_hud) {
+            _jobs.addJob("Hud::layout", {world}, {hud}, [this]{
+                // mix slowly and quickly changing values, like real telemetry
+                const b2Vec2 position = b2Body_GetPosition(_landerBodyId);
+                const b2Vec2 velocity = b2Body_GetLinearVelocity(_landerBodyId);
+                for(UnsignedInt i = 0; i != _hud->getFieldCount(); ++i) {
+                    _hud->setValue(i, i % 2 ? position.y*Float(i) : velocity.y);
+                }
+                _hud->setThrust({velocity.x, velocity.y});
+            });
+
+            _jobs.addJob("Hud::upload", {}, {hud}, [this]{
+                _hud->update();
+            }, JobGraph::Affinity::MainThread);
+        }
+
+        _jobs.addJob("CameraControl::updateProjection", {}, {camera}, [this]{
+            _cc->updateProjection();
+        });
+    }
+
+    void MoonLanderOffscreen::tick(const Float dt) {
+        Trace::Scope traceScope{"tick"};
+
+        _tickDt = dt;
+        _jobs.run(*_workers);
+
+        const b2Vec2 position = b2Body_GetPosition(_landerBodyId);
+        if(const Vector2 shift = _level->getOrigin().recenter({position.x, position.y}); !shift.isZero()) {
+            shiftOrigin(shift);
+        }
+
+        if(_redraw) {
+            _redraw->checkBodies(_worldId);
+            _redraw->checkCamera(_cc->getCamera());
+        }
+    }
+
+    /// Move the level, the lander and the camera by -@p shift, returns the number of bodies moved
+    std::size_t MoonLanderOffscreen::shiftOrigin(const Vector2 &shift) {
+        const std::size_t bodyCount = _level->shiftOrigin(shift) + 1;
+        shiftBody(_landerBodyId, shift);
+        _lander->syncObject(_landerBodyId);
+        _cc->moveTo(_cc->getContainerTranslation() - shift);
+        return bodyCount;
+    }
+
+    void MoonLanderOffscreen::draw() {
+        Trace::Scope traceScope{"draw"};
+
+        _framebuffer.clear(GL::FramebufferClear::Color);
+
+        if(_background) {
+            _background->update(_cc->getCamera(), _level->getStaticRevision(),
+                [this](SceneGraph::Camera2D &camera) { _level->drawStatic(camera); },
+                _framebuffer);
+            _background->draw();
+            _level->drawDynamic(_cc->getCamera());
+        } else {
+            _level->draw(_cc->getCamera());
+        }
+
+        _landerSprite->draw(
+                _cc->getCamera().projectionMatrix()*_cc->getCamera().cameraMatrix(),
+                _landerObject->transformationMatrix()
+                );
+
+        _engineEffectSprite->draw(
+                _cc->getCamera().projectionMatrix()*_cc->getCamera().cameraMatrix(),
+                _engineEffectObject->absoluteTransformationMatrix()
+                );
+
+        if(_debugDraw) {
+            const auto start = std::chrono::steady_clock::now();
+            SceneGraph::Camera2D &camera = _cc->getCamera();
+            const Range2D view = _cc->viewRectangle();
+            _debugDraw->draw(_worldId, view, camera.projectionMatrix()*camera.cameraMatrix(),
+                             view.sizeX()/Float(_size.x()));
+            _debugDrawStatistics.add(millisecondsBetween(start, std::chrono::steady_clock::now()));
+        }
+
+        if(_hud) {
+            _hud->draw();
+        }
+    }
+
+    bool MoonLanderOffscreen::checkGolden(const Int frame) {
+        const Image2D image = _framebuffer.read(_framebuffer.viewport(), {PixelFormat::RGBA8Unorm});
+        const auto filename = Utility::Path::join(_args.value("golden-dir"), std::format("frame-{:04}.png", frame));
+
+        if(_args.isSet("save-golden")) {
+            if(!Utility::Path::make(_args.value("golden-dir"))) {
+                Error{} << "Can't create golden image directory" << _args.value("golden-dir");
+                return false;
+            }
+
+            Containers::Pointer<Trade::AbstractImageConverter> converter =
+                _converterManager.loadAndInstantiate("AnyImageConverter");
+            if(!converter || !converter->convertToFile(image, filename)) {
+                Error{} << "Can't save golden image" << filename;
+                return false;
+            }
+
+            Debug{} << "Saved golden image" << filename;
+            return true;
+        }
+
+        Containers::Pointer<Trade::AbstractImporter> importer =
+            _importerManager.loadAndInstantiate("AnyImageImporter");
+        Optional<Trade::ImageData2D> golden;
+        if(!importer || !importer->openFile(filename) || !(golden = importer->image2D(0))) {
+            Error{} << "Can't open golden image" << filename;
+            return false;
+        }
+
+        if(golden->format() != PixelFormat::RGBA8Unorm || golden->size() != image.size()) {
+            Error{} << "Golden image" << filename << "is" << golden->format() << golden->size()
+                << "but rendered" << image.format() << image.size();
+            return false;
+        }
+
+        const auto actualPixels = image.pixels<Color4ub>();
+        const auto goldenPixels = golden->pixels<Color4ub>();
+
+        Int maxDelta = 0;
+        Double deltaSum = 0.0;
+        for(std::size_t y = 0; y != actualPixels.size()[0]; ++y) {
+            for(std::size_t x = 0; x != actualPixels.size()[1]; ++x) {
+                const Vector4i delta = Math::abs(Vector4i{actualPixels[y][x]} - Vector4i{goldenPixels[y][x]});
+                maxDelta = Math::max(maxDelta, delta.max());
+                deltaSum += delta.sum();
+            }
+        }
+
+        const Double meanDelta = deltaSum/Double(image.size().product()*4);
+        const bool passed = maxDelta <= _args.value<Int>("max-delta")
+            && meanDelta <= _args.value<Double>("mean-delta");
+
+        if(passed) {
+            Debug{} << "Frame" << frame << "matches" << filename
+                << "(max delta:" << maxDelta << Debug::nospace << ", mean delta:" << meanDelta << Debug::nospace << ")";
+        } else {
+            Error{} << "Frame" << frame << "differs from" << filename
+                << "(max delta:" << maxDelta << Debug::nospace << ", mean delta:" << meanDelta << Debug::nospace << ")";
+        }
+
+        return passed;
+    }
+
+    /**
+     * Runs @p frames more simulation ticks, by now the scene is expected to
+     * be in a steady state where neither the game nor Box2D allocate.
+     */
+    bool MoonLanderOffscreen::checkSteadyStateAllocations(const Int frames) {
+        if(!AllocationTracker::isEnabled()) {
+            Error{} << "Allocation check needs a build with MOONLANDER_ALLOCATION_TRACKING";
+            return false;
+        }
+
+        AllocationTracker::setCallstackCapture(true);
+        const AllocationTracker::Counters start = AllocationTracker::globalCounters();
+        const AllocationTracker::Counters box2DStart = AllocationTracker::box2DCounters();
+        for(Int frame = 0; frame != frames; ++frame) {
+            tick(_timeStep);
+        }
+        const AllocationTracker::Counters end = AllocationTracker::globalCounters();
+        const AllocationTracker::Counters box2DEnd = AllocationTracker::box2DCounters();
+        AllocationTracker::setCallstackCapture(false);
+
+        const UnsignedLong box2DAllocations = box2DEnd.allocations - box2DStart.allocations;
+        if(const UnsignedLong allocations = end.allocations - start.allocations + box2DAllocations) {
+            Error{} << allocations << "allocations," << end.bytes - start.bytes + box2DEnd.bytes - box2DStart.bytes
+                << "bytes in" << frames << "steady-state ticks," << box2DAllocations << "of them by Box2D";
+            AllocationTracker::printCallstacks();
+            return false;
+        }
+
+        Debug{} << "No allocations in" << frames << "steady-state ticks";
+        return true;
+    }
+
+    void MoonLanderOffscreen::printWorldCounters(const char *label) const {
+        const b2Counters counters = b2World_GetCounters(_worldId);
+        Debug{} << label << counters.bodyCount << "bodies," << counters.shapeCount << "shapes,"
+            << counters.contactCount << "broadphase pairs, static tree height" << counters.staticTreeHeight;
+    }
+
+    /**
+     * Carves @p count craters at pseudo-random but reproducible spots and
+     * times each carve + rebuild, the incremental rebuild should keep this
+     * flat no matter how wide the terrain is.
+     */
+    void MoonLanderOffscreen::benchmarkCraters(const Int count) {
+        Terrain &terrain = _level->getTerrain();
+        FrameStatistics statistics{std::size_t(count)};
+
+        UnsignedInt seed = 12345;
+        const auto random = [&seed]() {
+            seed = seed*1664525u + 1013904223u;
+            return Float(seed >> 8)/Float(1 << 24);
+        };
+
+        const UnsignedLong rebuiltBefore = terrain.getRebuiltSegmentCount();
+        for(Int i = 0; i != count; ++i) {
+            const Float x = Math::lerp(-19.0f, 19.0f, random());
+            const Float radius = Math::lerp(0.5f, 2.5f, random());
+
+            const auto start = std::chrono::steady_clock::now();
+            terrain.carve({x, terrain.heightAt(x) + radius*0.5f}, radius);
+            terrain.rebuild();
+            statistics.add(millisecondsBetween(start, std::chrono::steady_clock::now()));
+        }
+
+        statistics.print("crater carve + rebuild:");
+        Debug{} << "terrain:" << terrain.getRebuiltSegmentCount() - rebuiltBefore << "segments rebuilt for"
+            << count << "craters," << terrain.getSegmentCount() << "segments total";
+    }
+
+    /**
+     * Times @p count full scans with nothing reused and compares them to
+     * the world step, the scanner should stay a small slice of it.
+     */
+    void MoonLanderOffscreen::benchmarkScanner(const Int count) {
+        FrameStatistics statistics{std::size_t(count)};
+        for(Int i = 0; i != count; ++i) {
+            _scanner->invalidate();
+            const auto start = std::chrono::steady_clock::now();
+            _scanner->scan(_worldId, _landerBodyId, _level->getStaticRevision());
+            statistics.add(millisecondsBetween(start, std::chrono::steady_clock::now()));
+        }
+
+        _scanner->print();
+        statistics.print("full scan:");
+        Debug{} << "scanner: altitude" << _scanner->getAltitude().distance << "clearance"
+            << _scanner->getClosestDistance();
+        // no step ran yet, or it was below the timer resolution
+        if(const Double stepMilliseconds = _stepScheduler.stepMilliseconds(); stepMilliseconds > 0.0) {
+            Debug{} << "scanner: a full scan is" << statistics.mean()/stepMilliseconds*100.0
+                << Debug::nospace << "% of the last step";
+        } else {
+            Debug{} << "scanner: no step time measured to compare a full scan to";
+        }
+    }
+
+    /**
+     * Stands in for a long session going through levels: the remaining
+     * sprite sheets are requested round-robin, so with a budget smaller
+     * than all of them together they keep getting evicted and reloaded.
+     */
+    void MoonLanderOffscreen::churnTextures(const Int count) {
+        const TextureHandle handles[]{
+            _asset.addTexture(Assets::Capsule),
+            _asset.addTexture(Assets::CapsuleEffect),
+            _asset.addTexture(Assets::ShipEngine),
+            _asset.addTexture(Assets::ShipHull),
+        };
+
+        FrameStatistics statistics{std::size_t(count)};
+        for(Int i = 0; i != count; ++i) {
+            const auto start = std::chrono::steady_clock::now();
+            _asset.getTexture(handles[i % 4]);
+            statistics.add(millisecondsBetween(start, std::chrono::steady_clock::now()));
+        }
+
+        statistics.print("texture request:");
+        _asset.print();
+        if(_asset.getBudget() && _asset.getPeakBytes() > _asset.getBudget()) {
+            Warning{} << "texture budget exceeded by pinned or single textures";
+        }
+    }
+
+    static Script waitForever(Signal &signal) {
+        co_await waitFor(signal);
+    }
+
+    static Script sleepThenWait(const Double seconds, Signal &signal) {
+        co_await sleep(seconds);
+        co_await waitFor(signal);
+    }
+
+    /**
+     * Suspends @p count scripts, half waiting for a signal and half
+     * sleeping past the end of the run, and times scheduler updates while
+     * they wait. Waiting scripts should cost nothing, so this stays flat
+     * no matter the count. Then everything is woken at once.
+     */
+    void MoonLanderOffscreen::benchmarkScripts(const Int count) {
+        Signal signal;
+        FrameStatistics statistics{600};
+        {
+            ScriptScheduler scheduler;
+            for(Int i = 0; i != count; ++i) {
+                scheduler.start(i % 2 ? waitForever(signal) : sleepThenWait(3600.0, signal));
+            }
+            // the first update runs every script up to its first wait
+            scheduler.update(_timeStep);
+
+            for(Int i = 0; i != 600; ++i) {
+                const auto start = std::chrono::steady_clock::now();
+                scheduler.update(_timeStep);
+                statistics.add(millisecondsBetween(start, std::chrono::steady_clock::now()));
+            }
+
+            statistics.print("scheduler update while waiting:");
+            scheduler.print();
+
+            const auto start = std::chrono::steady_clock::now();
+            signal.fire();
+            scheduler.update(_timeStep);
+            Debug{} << "scripts: waking" << scheduler.getResumedCount() << "took"
+                << millisecondsBetween(start, std::chrono::steady_clock::now()) << "ms," << scheduler.getLiveCount()
+                << "still sleeping";
+        }
+    }
+
+    /**
+     * Breaks @p count objects apart above the terrain, cycling through the
+     * lander, capsule and ship hull templates with a crash every few ticks,
+     * and times each crash frame, spawn plus world step. Runs once with
+     * DebrisPool and once creating every piece with newWorldObjectBody(),
+     * both keeping at most as many pieces alive. The worst frames are the
+     * spikes a player would see.
+     */
+    void MoonLanderOffscreen::benchmarkCrashes(const Int count) {
+        constexpr Int TicksPerCrash = 10;
+        constexpr UnsignedInt Capacity = 256;
+        const FractureTemplate *const fractures[]{&LanderFracture, &CapsuleFracture, &ShipHullFracture};
+        const Vector2 halfSizes[]{{1.0f, 1.0f}, {1.0f, 0.7f}, {0.9f, 1.0f}};
+
+        const auto parentTransform = [](const Int i) {
+            return b2Transform{{-12.0f + Float(i % 8)*3.0f, 8.0f}, b2MakeRot(0.3f*Float(i % 5))};
+        };
+        const b2Vec2 parentVelocity{2.0f, -6.0f};
+        constexpr Float parentSpin = 1.5f;
+
+        FrameStatistics pooled{std::size_t(count)};
+        {
+            DebrisPool::Configuration configuration;
+            configuration.capacity = Capacity;
+            DebrisPool debris{_shaders, _worldId, configuration};
+            for(UnsignedInt i = 0; i != 3; ++i) {
+                const TextureHandle texture = _asset.addTexture(fractures[i]->sprite);
+                _asset.pin(texture);
+                debris.addTemplate(*fractures[i], halfSizes[i], 4.0f*halfSizes[i].product(), _asset.getTexture(texture));
+            }
+
+            for(Int i = 0; i != count; ++i) {
+                const auto start = std::chrono::steady_clock::now();
+                debris.spawn(UnsignedInt(i % 3), parentTransform(i), parentVelocity, parentSpin);
+                _stepScheduler.step(_worldId, _timeStep);
+                debris.update(_timeStep);
+                pooled.add(millisecondsBetween(start, std::chrono::steady_clock::now()));
+
+                for(Int tick = 1; tick != TicksPerCrash; ++tick) {
+                    _stepScheduler.step(_worldId, _timeStep);
+                    debris.update(_timeStep);
+                }
+            }
+
+            debris.print();
+        }
+
+        FrameStatistics created{std::size_t(count)};
+        {
+            Containers::Array<b2BodyId> alive;
+            std::size_t oldest = 0;
+            for(Int i = 0; i != count; ++i) {
+                const FractureTemplate &fracture = *fractures[i % 3];
+                const Vector2 halfSize = halfSizes[i % 3];
+                const b2Transform transform = parentTransform(i);
+
+                const auto start = std::chrono::steady_clock::now();
+                for(UnsignedInt j = 0; j != fracture.pieceCount; ++j) {
+                    const FracturePiece &piece = fracture.pieces[j];
+                    Vector2 points[FracturePiece::MaxPoints];
+                    for(UnsignedInt k = 0; k != piece.pointCount; ++k) {
+                        points[k] = (piece.points[k] - piece.centroid)*halfSize;
+                    }
+
+                    const b2Vec2 offset = b2RotateVector(transform.q, {piece.centroid.x()*halfSize.x(),
+                                                                       piece.centroid.y()*halfSize.y()});
+                    const b2Vec2 position = b2Add(transform.p, offset);
+                    const b2BodyId bodyId = newWorldObjectBody(_worldId, nullptr,
+                        DualComplex::translation({position.x, position.y})*
+                            DualComplex::rotation(Rad{b2Rot_GetAngle(transform.q)}),
+                        BodyShape::polygon({points, piece.pointCount}), b2_dynamicBody,
+                        BodyDefault::density, CollisionFilter::debris());
+                    b2Body_SetLinearVelocity(bodyId, b2Add(parentVelocity, b2CrossSV(parentSpin, offset)));
+                    b2Body_SetAngularVelocity(bodyId, parentSpin);
+                    Containers::arrayAppend(alive, bodyId);
+                }
+
+                // the same bound as the pool, oldest first
+                while(alive.size() - oldest > Capacity) {
+                    b2DestroyBody(alive[oldest++]);
+                }
+                _stepScheduler.step(_worldId, _timeStep);
+                created.add(millisecondsBetween(start, std::chrono::steady_clock::now()));
+
+                for(Int tick = 1; tick != TicksPerCrash; ++tick) {
+                    _stepScheduler.step(_worldId, _timeStep);
+                }
+            }
+
+            for(std::size_t i = oldest; i != alive.size(); ++i) {
+                b2DestroyBody(alive[i]);
+            }
+        }
+
+        pooled.print("crash frame, pooled debris:");
+        created.print("crash frame, debris created on impact:");
+        Debug{} << "crash: worst frame" << pooled.max() << "ms pooled," << created.max() << "ms created on impact";
+    }
+
+    /**
+     * Shifts the whole world by one origin cell @p count times, back and
+     * forth so it ends where it started, and times each shift and the
+     * world step right after it. Moved bodies land in the broadphase move
+     * buffer, so that step pays for finding their pairs again.
+     */
+    void MoonLanderOffscreen::benchmarkOriginShifts(const Int count) {
+        const Float cellSize = _level->getOrigin().configuration().cellSize;
+
+        FrameStatistics steps{std::size_t(count)};
+        for(Int i = 0; i != count; ++i) {
+            const auto start = std::chrono::steady_clock::now();
+            _stepScheduler.step(_worldId, _timeStep);
+            steps.add(millisecondsBetween(start, std::chrono::steady_clock::now()));
+        }
+
+        FrameStatistics shifts{std::size_t(count)};
+        FrameStatistics stepsAfter{std::size_t(count)};
+        std::size_t bodyCount = 0;
+        for(Int i = 0; i != count; ++i) {
+            const Vector2 shift = Vector2::xAxis(i % 2 ? -cellSize : cellSize);
+
+            const auto start = std::chrono::steady_clock::now();
+            bodyCount = shiftOrigin(shift);
+            const auto shifted = std::chrono::steady_clock::now();
+            _stepScheduler.step(_worldId, _timeStep);
+            const auto stepped = std::chrono::steady_clock::now();
+
+            shifts.add(millisecondsBetween(start, shifted));
+            stepsAfter.add(millisecondsBetween(shifted, stepped));
+        }
+
+        shifts.print("origin shift:");
+        stepsAfter.print("world step after a shift:");
+        steps.print("world step:");
+        Debug{} << "origin:" << bodyCount << "bodies moved per shift, worst" << shifts.max() << "ms,"
+            << shifts.max()*1.0e6/Double(Math::max(bodyCount, std::size_t{1})) << "ns per body";
+    }
+
+    /**
+     * Swings a capsule on ropes of more and more segments, each in a world
+     * of its own with just the ground, a lander carried sideways back and
+     * forth and the rope, so the step time is the rope's. The rope is cut
+     * finer, not made longer, and the worst gap between linked segments
+     * shows whether it holds together at six substeps.
+     */
+    void MoonLanderOffscreen::benchmarkRopes(const Int ticks) {
+        constexpr Int SubSteps = 6;
+        constexpr UnsignedInt SegmentCounts[]{50, 100, 200, 300, 400, 500};
+        const Vector2 landerHalfSize{1.6f};
+        const Vector2 capsuleHalfSize{1.12f, 0.8f};
+
+        Double meanAt500 = 0.0;
+        for(const UnsignedInt segmentCount: SegmentCounts) {
+            b2WorldDef worldDef = b2DefaultWorldDef();
+            worldDef.gravity = GravityConstant::Moon;
+            worldDef.workerCount = Int(_workers->getThreadCount());
+            worldDef.enqueueTask = WorkerPool::enqueueBox2DTask;
+            worldDef.finishTask = WorkerPool::finishBox2DTask;
+            worldDef.userTaskContext = &*_workers;
+            const b2WorldId worldId = b2CreateWorld(&worldDef);
+
+            newWorldObjectBody(worldId, nullptr, DualComplex::translation({0.0f, -20.0f}), Vector2{40.0f, 1.0f},
+                               b2_staticBody, 1.0f, CollisionFilter::staticGeometry());
+            // carried by the script below and not by thrust, so every run swings the same
+            const b2BodyId landerId = newWorldObjectBody(worldId, nullptr, DualComplex::translation({0.0f, 0.0f}),
+                landerHalfSize, b2_kinematicBody, 2.0f, CollisionFilter::lander());
+
+            Rope::Configuration configuration;
+            configuration.segmentCount = segmentCount;
+            const b2BodyId capsuleId = newWorldObjectBody(worldId, nullptr,
+                DualComplex::translation({0.0f, -landerHalfSize.y() - configuration.length - capsuleHalfSize.y()}),
+                capsuleHalfSize, b2_dynamicBody, 2.0f, CollisionFilter::box());
+            Rope rope{_shaders, worldId, landerId, {0.0f, -landerHalfSize.y()}, capsuleId,
+                      {0.0f, capsuleHalfSize.y()}, configuration};
+
+            FrameStatistics steps{std::size_t(ticks)};
+            FrameStatistics updates{std::size_t(ticks)};
+            Float maxGap = 0.0f;
+            Float maxStretch = 0.0f;
+            for(Int i = 0; i != ticks; ++i) {
+                const Float time = Float(i)*_timeStep;
+                b2Body_SetLinearVelocity(landerId, {6.0f*Math::cos(Rad{time*1.5f}), 0.0f});
+
+                const auto start = std::chrono::steady_clock::now();
+                b2World_Step(worldId, _timeStep, SubSteps);
+                const auto stepped = std::chrono::steady_clock::now();
+                rope.update();
+                const auto updated = std::chrono::steady_clock::now();
+
+                steps.add(millisecondsBetween(start, stepped));
+                updates.add(millisecondsBetween(stepped, updated));
+                maxGap = Math::max(maxGap, rope.getMaxJointGap());
+                const Float distance = b2Distance(b2Body_GetWorldPoint(landerId, {0.0f, -landerHalfSize.y()}),
+                                                  b2Body_GetWorldPoint(capsuleId, {0.0f, capsuleHalfSize.y()}));
+                maxStretch = Math::max(maxStretch, distance/configuration.length - 1.0f);
+            }
+
+            Debug{} << "rope:" << segmentCount << "segments, step mean" << steps.mean() << "ms, max" << steps.max()
+                << "ms, strip" << updates.mean() << "ms, worst joint gap" << maxGap*1000.0f << "mm, stretch"
+                << maxStretch*100.0f << Debug::nospace << "%";
+            if(segmentCount == 500) meanAt500 = steps.mean();
+
+            // the rope's destructor doesn't touch a destroyed world
+            b2DestroyWorld(worldId);
+        }
+
+        Debug{} << "rope: 500 segments and the lander step in" << meanAt500 << "ms,"
+            << (meanAt500 < 1.0 ? "within" : "over") << "the 1 ms target";
+    }
+
+    int MoonLanderOffscreen::exec() {
+        using Clock = std::chrono::steady_clock;
+
+        const Int frames = _args.value<Int>("frames");
+        const Int goldenInterval = _args.value<Int>("golden-interval");
+        const bool golden = !_args.value("golden-dir").empty();
+
+        FrameStatistics tickStatistics{std::size_t(frames)};
+        FrameStatistics drawStatistics{std::size_t(frames)};
+        FrameStatistics frameStatistics{std::size_t(frames)};
+
+        bool passed = true;
+        for(Int frame = 1; frame <= frames; ++frame) {
+            const auto frameStart = Clock::now();
+            {
+                // jobs of the tick allocate on the worker threads as well
+                AllocationTracker::Scope allocationScope{_allocations, _tickAllocationScope, AllocationTracker::Threads::All};
+                tick(_timeStep);
+            }
+
+            // a skipped frame leaves the previous, still correct one in the framebuffer
+            const auto drawStart = Clock::now();
+            if(!_redraw || _redraw->consume()) {
+                AllocationTracker::Scope allocationScope{_allocations, _drawAllocationScope};
+                draw();
+            }
+
+            // submission is CPU side, finishing makes the software rasterizer cost visible as well
+            const auto finishStart = Clock::now();
+            {
+                Trace::Scope finishScope{"finish"};
+                GL::Renderer::finish();
+            }
+            const auto frameEnd = Clock::now();
+
+            tickStatistics.add(millisecondsBetween(frameStart, drawStart));
+            drawStatistics.add(millisecondsBetween(drawStart, finishStart));
+            frameStatistics.add(millisecondsBetween(frameStart, frameEnd));
+            _allocations.endFrame();
+
+            if(golden && (frame == frames || (goldenInterval > 0 && frame % goldenInterval == 0))) {
+                passed = checkGolden(frame) && passed;
+            }
+
+            // bake once the scene has settled, so pair counts before and after compare
+            if(_args.isSet("bake-static") && frame == frames/2) {
+                printWorldCounters("world before bake:");
+                _level->bakeStaticGeometry();
+            }
+        }
+
+        printWorldCounters(_args.isSet("bake-static") ? "world after bake:" : "world:");
+
+        tickStatistics.print("tick:");
+        drawStatistics.print("draw submit:");
+        frameStatistics.print("frame:");
+        _jobs.print();
+        if(_physicsLod) {
+            Debug{} << "physics lod: active" << _physicsLod->count(PhysicsLod::State::Active)
+                << "settling" << _physicsLod->count(PhysicsLod::State::Settling)
+                << "frozen" << _physicsLod->count(PhysicsLod::State::Frozen);
+        }
+        if(const InstancedShapes &instanced = _level->getInstancedShapes(); instanced.getCount()) {
+            _level->getMeshCache().print();
+            Debug{} << "instanced:" << instanced.getCount() << "bodies in" << instanced.getBatchCount()
+                << "draws," << instanced.getGpuBytes() << "bytes of instance data";
+        }
+        if(_redraw) {
+            _redraw->print();
+            Debug{} << "background layer rendered" << _background->getRenderCount() << "times";
+        }
+        if(_debugDraw) {
+            _debugDrawStatistics.print("debug draw submit:");
+            Debug{} << "debug draw:" << _debugDraw->getTriangleVertexCount()/3 << "triangles,"
+                << _debugDraw->getLineVertexCount()/2 << "lines in the last frame";
+        }
+        if(_hud) {
+            Debug{} << "hud:" << _hud->getFieldCount() << "fields," << _hud->getLayoutCount() << "field layouts in"
+                << frames << "frames";
+        }
+        if(AllocationTracker::isEnabled()) {
+            _allocations.print();
+        }
+
+        if(_scanner) {
+            benchmarkScanner(1000);
+        }
+
+        if(const Int ticks = _args.value<Int>("rope-benchmark"); ticks > 0) {
+            benchmarkRopes(ticks);
+        }
+
+        if(const Int shifts = _args.value<Int>("origin-shifts"); shifts > 0) {
+            benchmarkOriginShifts(shifts);
+        }
+
+        if(const Int crashes = _args.value<Int>("crash-benchmark"); crashes > 0) {
+            benchmarkCrashes(crashes);
+        }
+
+        if(const Int scripts = _args.value<Int>("scripts"); scripts > 0) {
+            benchmarkScripts(scripts);
+        }
+
+        if(const Int requests = _args.value<Int>("texture-churn"); requests > 0) {
+            churnTextures(requests);
+        }
+
+        if(const Int craters = _args.value<Int>("benchmark-craters"); craters > 0) {
+            benchmarkCraters(craters);
+        }
+
+        if(const std::string trace = _args.value("trace"); !trace.empty()) {
+            Trace::write(trace);
+        }
+
+        if(const Int ticks = _args.value<Int>("zero-allocation-ticks"); ticks > 0) {
+            passed = checkSteadyStateAllocations(ticks) && passed;
+        }
+
+        return passed ? 0 : 1;
+    }
+}
+
+MAGNUM_WINDOWLESSAPPLICATION_MAIN(Magnum::Game::MoonLanderOffscreen)